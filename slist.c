@@ -1,12 +1,14 @@
 #include "slist.h"
 
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <assert.h>
-
-struct SlistNode{
-	struct SlistNode *next;
-	void *data;
-};
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 struct Slist {
 	struct SlistNode *head;
@@ -17,12 +19,248 @@ struct Slist {
 	SlistDataEqu  *data_equ;
 	SlistDataCopy *data_copy;
 	SlistDataFree *data_free;
+	SlistDataFreeBatch *data_free_batch;  /* NULL: data_free one by one */
+	
+	SlistNodePool *pool;  /* NULL: nodes come from malloc */
+	bool intrusive;       /* nodes are embedded in the data, never allocated */
+	bool sorted;          /* sorted mode: every edit keeps data_cmp order */
+	
+	size_t data_size;     /* 0: data are pointers, else the pool's inline size */
+	void *scratch;        /* inline removals hand their data out from here */
+	size_t scratch_size;
+	
+	struct SlistIndex *index;  /* NULL: positional access walks the list */
+	struct SlistHash  *hash;   /* NULL: lookups by data walk the list */
+	struct SlistPrefetch *prefetch;  /* NULL: scans follow next pointers */
+	struct SlistCompact  *compact;   /* NULL: no relayout in progress */
+	
+	struct SlistMap *map;  /* not NULL: read only view of a snapshot file, no nodes */
+	
+	Slist *source;             /* not NULL: a lazy copy, the nodes after share_prev are source's */
+	SlistNode *share_prev;     /* last node of the list's own, or the head sentinel */
+	size_t share_rank;         /* share_prev's rank */
+	Slist *views;              /* lazy copies reading this list's nodes */
+	Slist *view_prev;          /* neighbours among the lazy copies of one source */
+	Slist *view_next;
+	
+#ifdef SLIST_STATS
+	SlistStats stats;
+	SlistOp stats_op;      /* walks are charged to the operation counted last */
+#endif
+};
+
+/* nodes are handed out from slabs of slab_nodes nodes, freed nodes are 
+   chained through their next pointer and reused before the slab grows */
+struct SlistNodeSlab {
+	struct SlistNodeSlab *next;
+	size_t used;
+	size_t size;  /* slab_nodes, or more for one batch */
+	unsigned char *base;  /* first node, cache line aligned */
+	unsigned char mem[];
+};
+
+struct SlistNodePool {
+	struct SlistNodeSlab *slabs;
+	SlistNode *free_nodes;
+	size_t slab_nodes;
+	
+	size_t node_size;  /* stride, nodes never straddle a cache line needlessly */
+	size_t data_size;  /* inline payload after each node, 0 for plain nodes */
+	size_t owners;     /* lists sharing a pool made by slist_create_inline, 0 for caller pools */
+};
+
+#define SLIST_CACHE_LINE 64
+#define SLIST_INLINE_SLAB_NODES 256
+#define SLIST_FREE_BATCH 256  /* data per data_free_batch call */
+#define SLIST_GALLOP_RATIO 8  /* a list this many times longer is searched, not walked */
+
+/* inline data sit right behind the node, node->data points at them */
+#define SLIST_NODE_PAYLOAD(node) ((void *)((unsigned char *)(node) + sizeof(SlistNode)))
+
+/* optional indexable skip list over the nodes: a node gets a tower of 
+   level L with probability 1/4^L, link[k].span counts the nodes passed when
+   following link[k].next. The head sentinel is rank 0, index i is rank i+1. */
+#define SLIST_INDEX_MAXLEVEL 32
+#define SLIST_RANK_UNKNOWN   ((size_t)-1)
+
+struct SlistIndexTower {
+	SlistNode *node;
+	struct SlistIndexLink {
+		struct SlistIndexTower *next;
+		size_t span;  /* unused when next is NULL */
+	} link[];
+};
+
+struct SlistIndex {
+	struct SlistIndexTower *header;
+	struct SlistIndexTower *last[SLIST_INDEX_MAXLEVEL];  /* O(1) append */
+	size_t last_rank[SLIST_INDEX_MAXLEVEL];
+	int level;
+	bool stale;  /* towers are rebuilt on the next positional access */
+	unsigned int seed;
+};
+
+/* optional open addressing table on data_hash, one entry per node holding 
+   the node's predecessor, so a hit can be unlinked in O(1). linear probing
+   with backward shift deletion, prev == NULL marks a free slot. */
+struct SlistHashEntry {
+	SlistNode *prev;
+	size_t hash;
+};
+
+struct SlistHash {
+	SlistDataHash *data_hash;
+	struct SlistHashEntry *slots;
+	size_t mask;
+	size_t used;
+	bool stale;  /* table is rebuilt on the next lookup */
+};
+
+/* optional jump table, nodes[i] is the node at index i. scans walk the 
+   table and request nodes distance ahead, so cache misses overlap instead 
+   of waiting on every next pointer. appends keep it, other edits mark it 
+   stale and the next scan rebuilds it in one walk. */
+#define SLIST_PREFETCH_DISTANCE 16
+
+#if defined(__GNUC__)
+#define SLIST_PREFETCH(addr)       __builtin_prefetch((addr), 0, 3)
+#define SLIST_PREFETCH_WRITE(addr) __builtin_prefetch((addr), 1, 3)
+#else
+#define SLIST_PREFETCH(addr)       ((void)0)
+#define SLIST_PREFETCH_WRITE(addr) ((void)0)
+#endif
+
+struct SlistPrefetch {
+	SlistNode **nodes;
+	size_t size;      /* capacity, list->count entries are used */
+	size_t distance;
+	bool stale;       /* table is rebuilt on the next scan */
+};
+
+/* an incremental relayout: nodes up to prev are already in block, in list
+   order. edits after prev leave it alone, edits before it shift rank, edits
+   at an unknown position or relinking restart it from the head. */
+struct SlistCompact {
+	unsigned char *block;  /* slots reserved in a slab of the list's pool */
+	size_t size;
+	size_t used;
+	SlistNode *prev;       /* last relocated node, or the head sentinel */
+	size_t rank;           /* prev's rank */
+	bool stale;
+};
+
+/* snapshot file: a header, then count records of stride bytes in list order
+   starting at offset. a record is the data by value, the next one is implicit,
+   so the file holds no addresses and maps anywhere. native endian. */
+#define SLIST_SNAPSHOT_MAGIC  "SLISTSNP"
+#define SLIST_SNAPSHOT_VERSION 1
+#define SLIST_SNAPSHOT_HEADER 64          /* records start on a cache line */
+#define SLIST_SNAPSHOT_BUFFER (1 << 20)   /* bytes per write(2) */
+
+struct SlistSnapshotHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;  /* 0x01020304 as written */
+	uint64_t count;
+	uint64_t data_size;
+	uint64_t stride;      /* data_size rounded up to 8 */
+	uint64_t offset;
+};
+
+struct SlistMap {
+	void *addr;
+	size_t length;
+	unsigned char *records;
+	size_t stride;
+	SlistNode *nodes;  /* built by the first node function, point into the records */
 };
 
-static SlistNode *slist_node_create(void *data);
+/* lazy copies: slist_copy_lazy makes a view of its source. A view owns a
+   prefix of its chain, the nodes after it are the last nodes of the source's
+   chain and the view never writes them: an edit first copies them up to its
+   position into the prefix. The source keeps its nodes, before it writes one
+   every view reading it copies its way past first. Node handles are only ever
+   handed out for a list's own nodes, so they stay in it. A source that frees
+   its nodes gives the last ones to the view reading most of them instead. */
+
+/* usage counters, -DSLIST_STATS compiles them in. disabled, every macro is
+   empty and a walk's node count is left for the compiler to drop */
+#ifdef SLIST_STATS
+#define SLIST_STAT_CALL(list, op)     ((list)->stats.calls[(op)]++, (list)->stats_op = (op))
+#define SLIST_STAT_WALK(list, nodes)  slist_stats_walk((list), (list)->stats_op, (nodes))
+#define SLIST_STAT_EXIST(list, nodes) ((list)->stats.calls[SLIST_OP_NODE_EXIST]++, \
+                                       slist_stats_walk((list), SLIST_OP_NODE_EXIST, (nodes)))
+#define SLIST_STAT_ALLOC(list, n)     ((list)->stats.allocs += (n))
+#define SLIST_STAT_FREE(list, n)      ((list)->stats.frees += (n))
+#define SLIST_STAT_LENGTH(list)       ((list)->count > (list)->stats.max_count ? \
+                                       (void)((list)->stats.max_count = (list)->count) : (void)0)
+#else
+#define SLIST_STAT_CALL(list, op)     ((void)0)
+#define SLIST_STAT_WALK(list, nodes)  ((void)(nodes))
+#define SLIST_STAT_EXIST(list, nodes) ((void)(nodes))
+#define SLIST_STAT_ALLOC(list, n)     ((void)0)
+#define SLIST_STAT_FREE(list, n)      ((void)0)
+#define SLIST_STAT_LENGTH(list)       ((void)0)
+#endif
+
+static SlistNode *slist_node_create(Slist *list, void *data);
+static void slist_node_set_data(Slist *list, SlistNode *node, void *data);
+static void slist_nodes_release_all(Slist *list);
+static bool slist_scratch_reserve(Slist *list, size_t n);
+static void *slist_node_take_data(Slist *list, SlistNode *node, size_t i);
+static SlistNodePool *slist_node_pool_create_sized(size_t slab_nodes, size_t data_size);
+static struct SlistNodeSlab *slist_node_pool_grow(SlistNodePool *pool, size_t nodes);
+static bool slist_has_side_index(Slist *list);
+static Slist *slist_split_after(Slist *list, SlistNode *prev, size_t rank);
+static SlistNode *slist_node_at_rank(Slist *list, size_t rank);
+static void slist_link_after(Slist *list, SlistNode *prev, size_t rank, SlistNode *node);
+static SlistNode *slist_unlink_after(Slist *list, SlistNode *prev, size_t rank);
+static SlistNode *slist_index_seek(Slist *list, size_t rank, struct SlistIndexTower **update, size_t *update_rank);
+static int slist_index_random_level(struct SlistIndex *index);
+static void slist_index_invalidate(Slist *list);
+static bool slist_index_ready(Slist *list);
+static void slist_relinked(Slist *list);
+static void slist_hash_link(Slist *list, SlistNode *prev, SlistNode *node);
+static void slist_hash_unlink(Slist *list, SlistNode *prev, SlistNode *node);
+static SlistNode *slist_hash_find_prev(Slist *list, void *data);
+static bool slist_hash_ready(Slist *list);
+static bool slist_prefetch_reserve(struct SlistPrefetch *prefetch, size_t count);
+static void slist_prefetch_link(Slist *list, SlistNode *node);
+static void slist_prefetch_erase(Slist *list, size_t i);
+static void slist_prefetch_ahead(struct SlistPrefetch *prefetch, size_t i, size_t n);
+static bool slist_prefetch_ready(Slist *list);
+static void slist_compact_link(Slist *list, size_t rank);
+static void slist_compact_unlink(Slist *list, SlistNode *prev, size_t rank, SlistNode *node);
+static void slist_compact_end(Slist *list);
+static void slist_compact_end_block(Slist *list);
+static void slist_node_move(Slist *list, SlistNode *prev, size_t rank, SlistNode *slot);
+static Slist *slist_map_copy(Slist *list);
+static bool slist_map_nodes(Slist *list);
+static bool slist_share_able(Slist *list);
+static SlistNode *slist_share_own(Slist *list, SlistNode *node, size_t rank, size_t upto);
+static SlistNode *slist_share_at_rank(Slist *list, size_t rank, size_t upto);
+static SlistNode *slist_share_find(Slist *list, SlistNode *node);
+static bool slist_share_mine(Slist *list, size_t rank);
+static void slist_share_join(Slist *list, Slist *source);
+static void slist_share_adopt(Slist *list, Slist *from);
+static void slist_share_detach(Slist *list);
+static void slist_share_leave(Slist *list);
+static SlistNode *slist_nodes_copy(Slist *target, SlistNode *first, SlistNode **last);
+static int slist_nodes_rehome(Slist *list, Slist *target);
+static int slist_snapshot_flush(int fd, unsigned char *buf, size_t *used);
+static void slist_index_towers_free(struct SlistIndex *index);
+#ifdef SLIST_STATS
+static void slist_stats_walk(Slist *list, SlistOp op, size_t nodes);
+#endif
 static bool slist_node_is_exist(Slist *list, SlistNode *node);
 static void slist_add_node_first_internal(Slist *list, SlistNode *node);
 static void slist_add_node_last_internal (Slist *list, SlistNode *node);
+static int slist_add_node_sorted_internal(Slist *list, SlistNode *node);
+static SlistNode *slist_merge_nodes(SlistDataCmp *data_cmp, SlistNode *a, SlistNode *b);
+static void slist_sorted_check(Slist *list, SlistNode *prev, SlistNode *first, SlistNode *last);
+static bool slist_sorted_gallop(Slist *probed, size_t count);
+static size_t slist_sorted_seek(SlistDataCmp *data_cmp, SlistNode **nodes, size_t from, size_t n, void *data);
+static long slist_sorted_filter(Slist *list1, Slist *list2, bool common);
 
 // Slist new 
 Slist *slist_create()
@@ -31,6 +269,48 @@ Slist *slist_create()
 }
 
 Slist *slist_create_full(SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistDataCopy *data_copy, SlistDataFree *data_free)
+{
+	return slist_create_pool(data_cmp, data_equ, data_copy, data_free, NULL);
+}
+
+Slist *slist_create_intrusive(SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistDataFree *data_free)
+{
+	Slist *list = NULL;
+	
+	list = slist_create_pool(data_cmp, data_equ, NULL, data_free, NULL);
+	if (list == NULL) return NULL;
+	
+	list->intrusive = true;
+	
+	return list;
+}
+
+Slist *slist_create_inline(size_t data_size, SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistNodePool *pool)
+{
+	Slist *list = NULL;
+	bool own = false;
+	
+	assert(data_size > 0);
+	assert(pool == NULL || pool->data_size == data_size);
+	
+	if (pool == NULL) {
+		pool = slist_node_pool_create_sized(SLIST_INLINE_SLAB_NODES, data_size);
+		if (pool == NULL) return NULL;
+		own = true;
+	}
+	
+	list = slist_create_pool(data_cmp, data_equ, NULL, NULL, pool);
+	if (list == NULL) {
+		if (own) slist_node_pool_destroy(pool);
+		return NULL;
+	}
+	
+	if (own) pool->owners = 1; /* copies and splits share it from here on */
+	
+	return list;
+}
+
+Slist *slist_create_pool(SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistDataCopy *data_copy, SlistDataFree *data_free, SlistNodePool *pool)
 {
 	Slist *list = NULL;
 	
@@ -57,6 +337,32 @@ Slist *slist_create_full(SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistDa
 	list->data_equ  = data_equ;
 	list->data_copy = data_copy;
 	list->data_free = data_free;
+	list->data_free_batch = NULL;
+	
+	list->pool = pool;
+	list->intrusive = false;
+	list->sorted = false;
+	list->index = NULL;
+	list->hash = NULL;
+	list->prefetch = NULL;
+	list->compact = NULL;
+	list->map = NULL;
+	list->source = NULL;
+	list->share_prev = list->head;
+	list->share_rank = 0;
+	list->views = NULL;
+	list->view_prev = NULL;
+	list->view_next = NULL;
+	
+	list->data_size = pool ? pool->data_size : 0;
+	list->scratch = NULL;
+	list->scratch_size = 0;
+	if (pool && pool->owners) pool->owners++;
+	
+#ifdef SLIST_STATS
+	memset(&list->stats, 0, sizeof(list->stats));
+	list->stats_op = SLIST_OP_ADD_FIRST;
+#endif
 	
 	return list;
 }
@@ -66,8 +372,23 @@ void slist_destroy(Slist *list)
 {
 	assert(list != NULL);
 	assert(list->head != NULL);
-	assert(list->count == 0);
+	assert(list->count == 0 || list->map != NULL);
 	
+	if (list->map != NULL) {
+		munmap(list->map->addr, list->map->length);
+		free(list->map->nodes);
+		free(list->map);
+	}
+	
+	slist_index_disable(list);
+	slist_hash_disable(list);
+	slist_prefetch_disable(list);
+	slist_compact_end(list);
+	
+	if (list->pool && list->pool->owners && --list->pool->owners == 0)
+		slist_node_pool_destroy(list->pool);
+	
+	free(list->scratch);
 	free(list->head);
 	free(list);
 	
@@ -79,7 +400,8 @@ void slist_destroy_deep(Slist *list)
 	assert(list != NULL);
 	assert(list->head != NULL);
 	
-	slist_clear_deep(list);
+	if (list->map == NULL) /* mapped data belong to the file */
+		slist_clear_deep(list);
 	
 	slist_destroy(list);
 	
@@ -95,28 +417,34 @@ Slist *slist_copy(Slist *list)
 	assert(list != NULL);
 	assert(list->head != NULL);
 	
-	new_list = slist_create_full(list->data_cmp, 
+	SLIST_STAT_CALL(list, SLIST_OP_COPY);
+	SLIST_STAT_WALK(list, list->count);
+	
+	if (list->map != NULL) return slist_map_copy(list);
+	
+	new_list = slist_create_pool(list->data_cmp, 
 							     list->data_equ, 
 							     list->data_copy, 
-							     list->data_free);
+							     list->data_free,
+							     list->pool);
 	if (new_list == NULL) return NULL;
 	
 	assert(new_list != NULL);
 	assert(new_list->head != NULL);
 	
+	new_list->data_free_batch = list->data_free_batch;
+	
 	p = list->head->next;
 	while (p) {
-		new_node = (SlistNode *)malloc(sizeof(SlistNode));
-		if (new_node == NULL) {
-			slist_destroy_deep(new_list);
+		new_node = slist_node_create(new_list, p->data);
+		if (new_node == NULL) { /* the data are still list's */
+			slist_clear(new_list);
+			slist_destroy(new_list);
 			return NULL;
 		}
 		
 		assert(new_node != NULL);
 		
-		new_node->data = p->data;
-		new_node->next = NULL; 
-		
 		slist_add_node_last_internal(new_list, new_node);
 		
 		p = p->next;
@@ -124,6 +452,8 @@ Slist *slist_copy(Slist *list)
 	
 	assert(new_list->count == list->count);
 	
+	new_list->sorted = list->sorted;
+	
 	return new_list;
 }
  
@@ -135,18 +465,27 @@ Slist *slist_copy_deep(Slist *list)
 	assert(list != NULL);
 	assert(list->head != NULL);
 	
-	new_list = slist_create_full(list->data_cmp, 
+	SLIST_STAT_CALL(list, SLIST_OP_COPY);
+	SLIST_STAT_WALK(list, list->count);
+	
+	if (list->map != NULL) return slist_map_copy(list);
+	
+	new_list = slist_create_pool(list->data_cmp, 
 							     list->data_equ, 
 							     list->data_copy, 
-							     list->data_free);
+							     list->data_free,
+							     list->pool);
 	if (new_list == NULL) return NULL;
 	
 	assert(new_list != NULL);
 	assert(new_list->head != NULL);
 	
+	new_list->data_free_batch = list->data_free_batch;
+	
 	p = list->head->next;
 	while (p) {
-		new_node = (SlistNode *)malloc(sizeof(SlistNode));
+		/* inline data are copied by slist_node_create */
+		new_node = slist_node_create(new_list, list->data_size ? p->data : list->data_copy(p->data));
 		if (new_node == NULL) {
 			slist_destroy_deep(new_list);
 			return NULL;
@@ -154,9 +493,6 @@ Slist *slist_copy_deep(Slist *list)
 		
 		assert(new_node != NULL);
 		
-		new_node->data = list->data_copy(p->data);
-		new_node->next = NULL; 
-		
 		slist_add_node_last_internal(new_list, new_node);
 		
 		p = p->next;
@@ -164,26 +500,115 @@ Slist *slist_copy_deep(Slist *list)
 	
 	assert(new_list->count == list->count);
 	
+	new_list->sorted = list->sorted;
+	
 	return new_list;
 }
 
 // Slist clear 
-void slist_clear(Slist *list);
+void slist_clear(Slist *list)
+{
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_CLEAR);
+	
+	if (list->map != NULL) return;
+	
+	slist_nodes_release_all(list);
+	
+	return;
+}
+
 void slist_clear_deep(Slist *list)
 {
-	SlistNode *node = NULL;
+	void *batch[SLIST_FREE_BATCH];
+	SlistNode *p = NULL, *next = NULL;
+	size_t n = 0;
+	bool free_nodes = false;
 	
 	assert(list != NULL);
 	assert(list->head != NULL);
 	
-	while (list->head->next) {
-		node = list->head->next;
-		list->head->next = node->next;
-		list->data_free(node);
-		list->count--;
+	SLIST_STAT_CALL(list, SLIST_OP_CLEAR);
+	
+	if (list->map != NULL) return;
+	if (list->data_free_batch == NULL && list->data_free == NULL) {
+		slist_nodes_release_all(list);
+		return;
 	}
 	
-	assert(list->count == 0);
+	/* malloc nodes go in the same pass. next is read first, intrusive 
+	   data may hold the node they free */
+	free_nodes = list->pool == NULL && !list->intrusive && !slist_isshared(list);
+	SLIST_STAT_WALK(list, list->count);
+	for (p = list->head->next; p; p = next) {
+		next = p->next;
+		if (list->data_free_batch) {
+			batch[n++] = p->data;
+			if (n == SLIST_FREE_BATCH || next == NULL) {
+				list->data_free_batch(batch, n);
+				n = 0;
+			}
+		} else {
+			list->data_free(p->data);
+		}
+		if (free_nodes) free(p);
+	}
+	
+	if (free_nodes) {
+		SLIST_STAT_FREE(list, list->count);
+		list->head->next = NULL;
+	}
+	slist_nodes_release_all(list);
+	
+	return;
+}
+
+void slist_set_data_free_batch(Slist *list, SlistDataFreeBatch *data_free_batch)
+{
+	assert(list != NULL);
+	
+	list->data_free_batch = data_free_batch;
+	
+	return;
+}
+
+/* empty the list without looking at the data. a pooled list hands its whole
+   chain to the free list at once, intrusive nodes are simply forgotten */
+static void slist_nodes_release_all(Slist *list)
+{
+	SlistNode *node = NULL, *next = NULL, **nodes = NULL;
+	size_t i = 0, d = 0;
+	
+	slist_share_detach(list); /* nodes a view reads are not the list's to free */
+	
+	if (list->head->next != NULL && !list->intrusive) {
+		SLIST_STAT_FREE(list, list->count);
+		
+		if (list->pool != NULL) {
+			list->tail->next = list->pool->free_nodes;
+			list->pool->free_nodes = list->head->next;
+		} else if (list->prefetch != NULL && !list->prefetch->stale) { /* free() touches each node, fetch ahead */
+			nodes = list->prefetch->nodes;
+			d = list->prefetch->distance;
+			for (i = 0; i < list->count; i++) {
+				if (i + d < list->count) SLIST_PREFETCH_WRITE(nodes[i + d]);
+				free(nodes[i]);
+			}
+		} else {
+			SLIST_STAT_WALK(list, list->count);
+			for (node = list->head->next; node; node = next) {
+				next = node->next;
+				free(node);
+			}
+		}
+	}
+	
+	list->head->next = NULL;
+	list->tail = NULL;
+	list->count = 0;
+	slist_relinked(list);
 	
 	return;
 }
@@ -216,646 +641,3427 @@ void slist_node_free(struct SlistNode *node)
 	return;
 }
 
-static SlistNode *slist_node_create(void *data)
+// SlistNode pool
+SlistNodePool *slist_node_pool_create(size_t slab_nodes)
 {
-	SlistNode *node = NULL;
-	
-	node = (SlistNode *)malloc(sizeof(SlistNode));
-	if (node == NULL) return NULL;
-	
-	assert(node != NULL);
-	
-	node->data = data;
-	node->next = NULL;
-	
-	return node;
+	return slist_node_pool_create_sized(slab_nodes, 0);
 }
 
-// add_data --- !!!
-int slist_add_data_first(Slist *list, void *data)  // prepend  O(1) 
+SlistNodePool *slist_node_pool_create_inline(size_t slab_nodes, size_t data_size)
 {
-	SlistNode *new_node = NULL;
-	
-	assert(list != NULL);
-	assert(list->head != NULL);
+	if (data_size == 0) return NULL;
 	
-	new_node = slist_node_create(data);
-	if (new_node == NULL) return -1;
-	
-	assert(new_node != NULL);
-	
-	slist_add_node_first_internal(list, new_node);
-	
-	return 0;
+	return slist_node_pool_create_sized(slab_nodes, data_size);
 }
 
-int slist_add_data_last(Slist *list, void *data)   // append   O(1) or O(n)
+/* a node up to a cache line gets a power of two stride so it never crosses
+   a line, a bigger one starts on a line of its own */
+static SlistNodePool *slist_node_pool_create_sized(size_t slab_nodes, size_t data_size)
 {
-	SlistNode *new_node = NULL;
+	SlistNodePool *pool = NULL;
+	size_t size = 0, stride = 0;
 	
-	assert(list != NULL);
-	assert(list->head != NULL);
+	if (slab_nodes == 0) return NULL;
 	
-	new_node = slist_node_create(data);
-	if (new_node == NULL) return -1;
+	pool = (SlistNodePool *)malloc(sizeof(SlistNodePool));
+	if (pool == NULL) return NULL;
 	
-	assert(new_node != NULL);
+	assert(pool != NULL);
 	
-	slist_add_node_last_internal(list, new_node);
+	pool->slabs = NULL;
+	pool->free_nodes = NULL;
+	pool->slab_nodes = slab_nodes;
 	
-	return 0;
+	size = sizeof(SlistNode) + data_size;
+	if (size > SLIST_CACHE_LINE) {
+		stride = (size + SLIST_CACHE_LINE - 1) / SLIST_CACHE_LINE * SLIST_CACHE_LINE;
+	} else {
+		for (stride = sizeof(SlistNode); stride < size; stride *= 2);
+	}
+	
+	pool->node_size = stride;
+	pool->data_size = data_size;
+	pool->owners = 0;
+	
+	return pool;
 }
 
-int slist_add_data_index(Slist *list, size_t index, void *data) //O(n)
+void slist_node_pool_destroy(SlistNodePool *pool)
 {
-	SlistNode *new_node = NULL, *p = NULL;
+	struct SlistNodeSlab *slab = NULL;
 	
-	assert(list != NULL);
-	assert(list->head != NULL);
-	
-	if (index > list->count) return -1;
+	assert(pool != NULL);
 	
-	assert(index <= list->count);
+	while (pool->slabs) {
+		slab = pool->slabs;
+		pool->slabs = slab->next;
+		free(slab);
+	}
 	
-	new_node = slist_node_create(data);
-	if (new_node == NULL) return -2;
+	free(pool);
 	
-	assert(new_node != NULL);
+	return;
+}
+
+static struct SlistNodeSlab *slist_node_pool_grow(SlistNodePool *pool, size_t nodes)
+{
+	struct SlistNodeSlab *slab = NULL;
 	
-	for(p = list->head; index > 0; index--, p = p->next);
+	assert(pool != NULL);
 	
-	new_node->next = p->next;
-	p->next = new_node;
-	list->count++;
+	slab = (struct SlistNodeSlab *)malloc(sizeof(struct SlistNodeSlab) + SLIST_CACHE_LINE - 1 + nodes * pool->node_size);
+	if (slab == NULL) return NULL;
 	
-	if (list->tail->next) /* maintain tail pointer */
-		list->tail = list->tail->next;
-		
-	assert(list->tail->next == NULL);
+	slab->base = slab->mem + (SLIST_CACHE_LINE - (size_t)slab->mem % SLIST_CACHE_LINE) % SLIST_CACHE_LINE;
+	slab->used = 0;
+	slab->size = nodes;
+	slab->next = pool->slabs;
+	pool->slabs = slab;
 	
-	return 0;
+	return slab;
 }
 
-int slist_add_data_prev_node(Slist *list, SlistNode *anchor, void *data)
+void slist_node_init(SlistNode *node, void *data)
 {
-	SlistNode *new_node = NULL, *p = NULL;
-	
-	assert(list != NULL);
-	assert(list->head != NULL);
-	assert(anchor != NULL);
-	
-	new_node = slist_node_create(data);
-	if (new_node == NULL) return -1;
-	
-	assert(new_node != NULL);
+	assert(node != NULL);
 	
-	p = list->head;
-	while (p->next) {
-		if (p->next == anchor) {
-			new_node->next = p->next;
-			p->next = new_node;
-			list->count++;
-			
-			return 0;
-		}
-	}
+	node->next = NULL;
+	node->data = data;
 	
-	return -2;
+	return;
 }
 
-int slist_add_data_next_node_safe  (Slist *list, SlistNode *anchor, void *data) // O(n)
+void slist_node_release(Slist *list, SlistNode *node)
 {
 	assert(list != NULL);
-	assert(list->head != NULL);
-	assert(anchor != NULL);
+	assert(node != NULL);
 	
-	if (!slist_node_is_exist(list, anchor)) return -1;
+	if (list->intrusive) return; /* owned by its container */
 	
-	if (slist_add_data_next_node_unsafe(list, anchor, data) == -1) return -2;
+	SLIST_STAT_FREE(list, 1);
 	
-	return 0;
+	if (list->pool == NULL) {
+		free(node);
+		return;
+	}
+	
+	node->next = list->pool->free_nodes;
+	list->pool->free_nodes = node;
+	
+	return;
 }
 
-int slist_add_data_next_node_unsafe(Slist *list, SlistNode *anchor, void *data) // O(1)
+static SlistNode *slist_node_create(Slist *list, void *data)
 {
-	SlistNode *new_node = NULL;
+	SlistNode *node = NULL;
+	SlistNodePool *pool = NULL;
+	struct SlistNodeSlab *slab = NULL;
 	
 	assert(list != NULL);
-	assert(list->head != NULL);
-	assert(anchor != NULL);
+	assert(list->map == NULL);
 	
-	new_node = slist_node_create(data);
-	if (new_node == NULL) return -1;
+	if (list->intrusive) return NULL; /* only add_node_* on intrusive lists */
 	
-	assert(new_node != NULL);
+	pool = list->pool;
+	if (pool == NULL) {
+		node = (SlistNode *)malloc(sizeof(SlistNode));
+	} else if (pool->free_nodes != NULL) { /* recycle first */
+		node = pool->free_nodes;
+		pool->free_nodes = node->next;
+	} else {
+		slab = pool->slabs;
+		if (slab == NULL || slab->used == slab->size) {
+			slab = slist_node_pool_grow(pool, pool->slab_nodes);
+			if (slab == NULL) return NULL;
+		}
+		node = (SlistNode *)(slab->base + slab->used++ * pool->node_size);
+	}
+	if (node == NULL) return NULL;
 	
-	new_node->next = anchor->next;
-	anchor->next = new_node;
-	list->count++;
+	assert(node != NULL);
 	
-	if (list->tail->next) /* maintain tail pointer */
-		list->tail = list->tail->next;
+	SLIST_STAT_ALLOC(list, 1);
 	
-	assert(list->tail->next == NULL);
+	slist_node_set_data(list, node, data);
+	node->next = NULL;
 	
-	return 0;
+	return node;
 }
 
-int slist_add_data_sorted(struct Slist *list, void *data); // O(n)
-
-// add_node
-
-//һremove_one_by_nodeʹãժڵ㣬Ȼ롣
-//ûԽڵĲ룬removeժûкˡ
-
-static bool slist_node_is_exist(Slist *list, SlistNode *node)
+static void slist_node_set_data(Slist *list, SlistNode *node, void *data)
 {
-	SlistNode *p = NULL;
-	
-	assert(list != NULL);
-	assert(list->head != NULL);
-	assert(node != NULL);
-	
-	p = list->head->next;
-	while (p) {
-		if (p == node) return true;
-		p = p->next;
+	if (list->data_size) {
+		node->data = SLIST_NODE_PAYLOAD(node);
+		memcpy(node->data, data, list->data_size);
+	} else {
+		node->data = data;
 	}
 	
-	return false;
+	return;
 }
 
-static void slist_add_node_first_internal(Slist *list, SlistNode *node)
+/* inline data of a removed node are copied to the scratch buffer, slot i of
+   n reserved beforehand. they stay valid until the next removal. */
+static bool slist_scratch_reserve(Slist *list, size_t n)
 {
-	assert(list != NULL);
-	assert(list->head != NULL);
-	assert(node != NULL);
+	void *scratch = NULL;
 	
-	node->next = list->head->next;
-	list->head->next = node;
-	list->count++;
+	if (list->data_size == 0 || n <= list->scratch_size) return true;
 	
-	if (list->tail == NULL) /* maintain tail pointer */
-		list->tail = list->head->next;
+	scratch = realloc(list->scratch, n * list->data_size);
+	if (scratch == NULL) return false;
 	
-	assert(list->tail->next == NULL);
+	list->scratch = scratch;
+	list->scratch_size = n;
 	
-	return;
+	return true;
 }
 
-static void slist_add_node_last_internal(Slist *list, SlistNode *node)
+static void *slist_node_take_data(Slist *list, SlistNode *node, size_t i)
 {
-	assert(list != NULL);
-	assert(list->head != NULL);
-	assert(node != NULL);
+	void *data = NULL;
 	
-	if(list->tail == NULL) {
-		slist_add_node_first_internal(list, node);
-	} else {
-		node->next = NULL;
-		list->tail->next = node;
-		list->count++;
-		
-		list->tail = list->tail->next;
-	}
+	if (list->data_size == 0) return node->data;
 	
-	assert(list->tail->next == NULL);
+	data = (unsigned char *)list->scratch + i * list->data_size;
+	memcpy(data, node->data, list->data_size);
 	
-	return;
+	return data;
 }
 
-//ǰnodeС
-int slist_add_node_first(Slist *list, SlistNode *node)
+/* link node after prev, rank is prev's position (0 for the head sentinel) 
+   or SLIST_RANK_UNKNOWN, every insert path ends up here */
+static void slist_link_after(Slist *list, SlistNode *prev, size_t rank, SlistNode *node)
 {
+	struct SlistIndex *index = list->index;
+	struct SlistIndexTower *update[SLIST_INDEX_MAXLEVEL], *tower = NULL;
+	size_t update_rank[SLIST_INDEX_MAXLEVEL];
+	int k = 0, level = 0;
+	
 	assert(list != NULL);
-	assert(list->head != NULL);
+	assert(list->map == NULL);
+	assert(prev != NULL);
 	assert(node != NULL);
 	
-	if (slist_node_is_exist(list, node)) return -1;
+	if (list->source != NULL) { /* only the own prefix is written */
+		assert(rank == SLIST_RANK_UNKNOWN || rank <= list->share_rank);
+		if (prev == list->share_prev) list->share_prev = node;
+		list->share_rank++;
+	}
 	
-	slist_add_node_first_internal(list, node);
+	node->next = prev->next;
+	prev->next = node;
+	list->count++;
+	SLIST_STAT_LENGTH(list);
 	
-	return 0;
+	if (node->next == NULL) /* maintain tail pointer */
+		list->tail = node;
+	
+	assert(list->tail->next == NULL);
+	
+	if (list->sorted) 
+		slist_sorted_check(list, prev, node, node);
+	
+	if (list->hash != NULL) 
+		slist_hash_link(list, prev, node);
+	
+	if (list->prefetch != NULL) 
+		slist_prefetch_link(list, node);
+	
+	if (list->compact != NULL) 
+		slist_compact_link(list, rank);
+	
+	if (index == NULL || index->stale) return;
+	if (rank == SLIST_RANK_UNKNOWN) {
+		slist_index_invalidate(list);
+		return;
+	}
+	
+	rank++; /* rank of the new node from here on */
+	
+	level = slist_index_random_level(index);
+	
+	if (rank == list->count) { /* append, only the new tower's levels change */
+		for (k = 0; k < level; k++) {
+			update[k] = k < index->level ? index->last[k] : index->header;
+			update_rank[k] = k < index->level ? index->last_rank[k] : 0;
+		}
+	} else {
+		if (rank == 1) {
+			for (k = 0; k < index->level; k++) {
+				update[k] = index->header;
+				update_rank[k] = 0;
+			}
+		} else {
+			/* towers behind the new node are not crossed, their stale spans are harmless */
+			slist_index_seek(list, rank - 1, update, update_rank);
+		}
+		
+		for (k = 0; k < index->level; k++) {
+			if (index->last[k] != index->header && index->last_rank[k] >= rank)
+				index->last_rank[k]++;
+			if (k >= level && update[k]->link[k].next)
+				update[k]->link[k].span++;
+		}
+	}
+	
+	for (k = index->level; k < level; k++) {
+		update[k] = index->header;
+		update_rank[k] = 0;
+		index->header->link[k].next = NULL;
+		index->last[k] = index->header;
+		index->last_rank[k] = 0;
+	}
+	if (level > index->level) index->level = level;
+	
+	if (level == 0) return;
+	
+	tower = (struct SlistIndexTower *)malloc(sizeof(struct SlistIndexTower) + 
+	                                         level * sizeof(struct SlistIndexLink));
+	if (tower == NULL) { /* spans already count the node, rebuild later */
+		slist_index_invalidate(list);
+		return;
+	}
+	
+	tower->node = node;
+	for (k = 0; k < level; k++) {
+		tower->link[k].next = update[k]->link[k].next;
+		tower->link[k].span = 0;
+		if (tower->link[k].next)
+			tower->link[k].span = update[k]->link[k].span - (rank - 1 - update_rank[k]);
+		
+		update[k]->link[k].next = tower;
+		update[k]->link[k].span = rank - update_rank[k];
+		
+		if (tower->link[k].next == NULL) {
+			index->last[k] = tower;
+			index->last_rank[k] = rank;
+		}
+	}
+	
+	return;
 }
 
-//ǰnodeС
-int slist_add_node_last(Slist *list, SlistNode *node)
+/* unlink and return prev->next, rank is prev's position or SLIST_RANK_UNKNOWN, 
+   every remove path ends up here */
+static SlistNode *slist_unlink_after(Slist *list, SlistNode *prev, size_t rank)
 {
+	struct SlistIndex *index = list->index;
+	struct SlistIndexTower *update[SLIST_INDEX_MAXLEVEL], *tower = NULL, *next = NULL;
+	size_t update_rank[SLIST_INDEX_MAXLEVEL];
+	SlistNode *node = NULL;
+	int k = 0;
+	
 	assert(list != NULL);
-	assert(list->head != NULL);
-	assert(node != NULL);
+	assert(list->map == NULL);
+	assert(prev != NULL);
+	assert(prev->next != NULL);
 	
-	if (slist_node_is_exist(list, node)) return -1;
+	node = prev->next;
 	
-	slist_add_node_last_internal(list, node);
+	if (list->compact != NULL) 
+		slist_compact_unlink(list, prev, rank, node);
 	
-	return 0;
+	if (index != NULL && !index->stale) {
+		if (rank == SLIST_RANK_UNKNOWN) {
+			slist_index_invalidate(list);
+		} else {
+			slist_index_seek(list, rank, update, update_rank);
+			rank++; /* rank of the removed node */
+			
+			for (k = 0; k < index->level; k++) {
+				next = update[k]->link[k].next;
+				if (next != NULL && next->node == node) {
+					tower = next;
+					update[k]->link[k].next = tower->link[k].next;
+					if (tower->link[k].next)
+						update[k]->link[k].span += tower->link[k].span - 1;
+				} else if (next != NULL) {
+					update[k]->link[k].span--;
+				}
+				
+				if (index->last[k] == tower) {
+					index->last[k] = update[k];
+					index->last_rank[k] = update_rank[k];
+				} else if (index->last_rank[k] > rank) {
+					index->last_rank[k]--;
+				}
+			}
+			free(tower);
+			
+			while (index->level > 0 && index->header->link[index->level - 1].next == NULL)
+				index->level--;
+		}
+	}
+	
+	if (list->source != NULL) {
+		assert(rank == SLIST_RANK_UNKNOWN || rank < list->share_rank);
+		if (node == list->share_prev) list->share_prev = prev;
+		list->share_rank--;
+	}
+	
+	prev->next = node->next;
+	list->count--;
+	
+	if (list->tail == node)  /* maintain tail pointer */
+		list->tail = (prev == list->head) ? NULL : prev;
+	
+	if (list->hash != NULL) 
+		slist_hash_unlink(list, prev, node);
+	
+	if (list->prefetch != NULL) /* callers that know the position fix the table up */
+		list->prefetch->stale = true;
+	
+	assert(list->tail == NULL || list->tail->next == NULL);
+	
+	return node;
 }
 
-int slist_add_node_prev_node(Slist *list, SlistNode *anchor, SlistNode *node)
+/* node at rank, rank 0 is the head sentinel */
+static SlistNode *slist_node_at_rank(Slist *list, size_t rank)
 {
 	SlistNode *p = NULL;
 	
 	assert(list != NULL);
-	assert(list->head != NULL);
-	assert(anchor != NULL);
-	assert(node != NULL);
+	assert(rank <= list->count);
 	
-	if (slist_node_is_exist(list, node)) return -1;
+	if (rank == list->count && list->tail != NULL) return list->tail;
+	if (rank == 0) return list->head;
 	
-	p = list->head;
-	while (p->next) {
-		if (p->next == anchor) {
-			node->next = p->next;
-			p->next = node;
-			list->count++;
-			return 0;
-		}
-	}
+	if (list->prefetch != NULL && !list->prefetch->stale) 
+		return list->prefetch->nodes[rank - 1];
 	
-	return -1;	 
+	if (slist_index_ready(list)) 
+		return slist_index_seek(list, rank, NULL, NULL);
+	
+	SLIST_STAT_WALK(list, rank);
+	for (p = list->head; rank > 0; rank--, p = p->next);
+	
+	return p;
 }
 
-//ȡanchorһʹgetȡ֤anchorС
-int slist_add_node_next_node(Slist *list,  SlistNode *anchor,  SlistNode *node)
+// add_data --- !!!
+int slist_add_data_first(Slist *list, void *data)  // prepend  O(1) 
 {
+	SlistNode *new_node = NULL;
+	
 	assert(list != NULL);
 	assert(list->head != NULL);
-	assert(anchor != NULL);
-	assert(node != NULL);
 	
-	if (!slist_node_is_exist(list, anchor)) return -1;
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_FIRST);
 	
-	if (slist_add_node_next_node_unsafe(list, anchor, node) == -1) return -2;
+	if (list->map != NULL) return -1;
+	
+	new_node = slist_node_create(list, data);
+	if (new_node == NULL) return -1;
+	
+	assert(new_node != NULL);
+	
+	slist_add_node_first_internal(list, new_node);
 	
 	return 0;
 }
 
-int slist_add_node_next_node_unsafe(Slist *list,  SlistNode *anchor,  SlistNode *node)
+int slist_add_data_last(Slist *list, void *data)   // append   O(1) or O(n)
 {
+	SlistNode *new_node = NULL;
+	
 	assert(list != NULL);
 	assert(list->head != NULL);
-	assert(anchor != NULL);
-	assert(node != NULL);
 	
-	if (slist_node_is_exist(list, node)) return -1;
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_LAST);
 	
-	node->next = anchor->next;
-	anchor->next = node;
-	list->count++;
+	if (list->map != NULL) return -1;
+	if (slist_unshare(list) != 0) return -1; /* the tail is written */
 	
-	if (list->tail->next) /* maintain tail pointer */
-		list->tail = list->tail->next;
+	new_node = slist_node_create(list, data);
+	if (new_node == NULL) return -1;
 	
-	assert(list->tail->next == NULL);
+	assert(new_node != NULL);
+	
+	slist_add_node_last_internal(list, new_node);
 	
 	return 0;
 }
 
-int slist_add_node_sorted(Slist *list, SlistNode *node);
-
-
-// remove --- !!! -- O(n)
-int remove_one_by_data(struct Slist *list, void *data)
+//a pooled list takes the nodes it cannot recycle from one new block, 
+//the chain is spliced onto the tail once. all or nothing.
+int slist_add_data_last_batch(Slist *list, void **data, size_t n)
 {
-	SlistNode *p = NULL, *free_node = NULL;
+	size_t i = 0, take = 0;
+	SlistNode *first = NULL, *last = NULL, *node = NULL, *next = NULL;
+	SlistNodePool *pool = NULL;
+	struct SlistNodeSlab *slab = NULL;
 	
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(data != NULL || n == 0);
 	
-	p = list->head;
-	while (p->next) {
-		if (list->data_equ(p->next->data, data)) {
-			free_node = p->next;
-			p->next = free_node->next;
-			list->count--;
-			
-			if (list->tail == free_node)  /* maintain tail pointer */
-				list->tail = p;
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_LAST);
+	
+	if (list->map != NULL) return -1;
+	if (n == 0) return 0;
+	if (slist_unshare(list) != 0) return -1;
+	
+	pool = list->pool;
+	for (i = 0; i < n; ) {
+		if (pool == NULL || pool->free_nodes != NULL) {
+			node = slist_node_create(list, data[i]);
+			if (node == NULL) goto fail;
 			
-			assert(list->tail->next == NULL);
+			if (last) last->next = node; else first = node;
+			last = node;
+			i++;
+			continue;
+		}
+		
+		slab = pool->slabs;
+		if (slab == NULL || slab->used == slab->size) {
+			slab = slist_node_pool_grow(pool, n - i > pool->slab_nodes ? n - i : pool->slab_nodes);
+			if (slab == NULL) goto fail;
+		}
+		
+		for (take = slab->size - slab->used; take > 0 && i < n; take--, i++) {
+			node = (SlistNode *)(slab->base + slab->used++ * pool->node_size);
+			slist_node_set_data(list, node, data[i]);
+			SLIST_STAT_ALLOC(list, 1);
 			
-			list->data_free(free_node->data); 
-			free(free_node);
+			if (last) last->next = node; else first = node;
+			last = node;
+		}
+	}
+	last->next = NULL;
+	
+	if (slist_has_side_index(list)) { /* let every node reach the side indexes */
+		for (node = first; node; node = next) {
+			next = node->next;
+			slist_add_node_last_internal(list, node);
+		}
+		return 0;
+	}
+	
+	if (list->sorted) 
+		slist_sorted_check(list, list->tail ? list->tail : list->head, first, last);
+	
+	if (list->tail) 
+		list->tail->next = first;
+	else 
+		list->head->next = first;
+	list->tail = last;
+	list->count += n;
+	SLIST_STAT_LENGTH(list);
+	
+	/* an append leaves the done part of a compaction alone */
+	if (list->prefetch != NULL && !list->prefetch->stale) {
+		if (!slist_prefetch_reserve(list->prefetch, list->count)) {
+			list->prefetch->stale = true;
 			return 0;
 		}
-		p = p->next;
+		for (i = list->count - n, node = first; node; node = node->next) 
+			list->prefetch->nodes[i++] = node;
 	}
 	
+	return 0;
+	
+fail:
+	for (node = first; node != NULL && node != last; node = next) {
+		next = node->next;
+		slist_node_release(list, node);
+	}
+	if (last) slist_node_release(list, last);
+	
 	return -1;
 }
 
-int remove_all_by_data(struct Slist *list, void *data)
+int slist_add_data_index(Slist *list, size_t index, void *data) //O(n), O(logn) with index
 {
-	int ret = -1;
-	void *copy_data = NULL;
-	SlistNode *p = NULL, *free_node = NULL;
+	SlistNode *new_node = NULL, *p = NULL;
 	
 	assert(list != NULL);
 	assert(list->head != NULL);
 	
-	copy_data = list->data_copy(data); /* must copy data !!! */
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_INDEX);
 	
-	p = list->head;
-	while (p->next) {
-		if (list->data_equ(p->next->data, copy_data)) {
-			free_node = p->next;
-			p->next = free_node->next;
-			list->count--;
-			
-			if (list->tail == free_node)  /* maintain tail pointer */
-				list->tail = p;
-			
-			assert(list->tail->next == NULL);
-			
-			list->data_free(free_node->data); 
-			free(free_node);
-			
-			ret = 0;
-			continue;
-		}
-		p = p->next;
-	}
-	list->data_free(copy_data); /* must free copy_data !!! */
+	if (list->map != NULL) return -1;
+	if (index > list->count) return -1;
 	
-	return ret;
+	assert(index <= list->count);
+	
+	p = slist_share_at_rank(list, index, index);
+	if (p == NULL) return -2;
+	
+	new_node = slist_node_create(list, data);
+	if (new_node == NULL) return -2;
+	
+	assert(new_node != NULL);
+	
+	slist_link_after(list, p, index, new_node);
+	
+	return 0;
 }
 
-int remove_by_node(struct Slist *list, SlistNode *node)
+int slist_add_data_prev_node(Slist *list, SlistNode *anchor, void *data)
 {
-	SlistNode *p = NULL, *free_node = NULL;
+	size_t rank = 0;
+	SlistNode *new_node = NULL, *p = NULL;
 	
 	assert(list != NULL);
 	assert(list->head != NULL);
-	assert(node != NULL);
+	assert(anchor != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_ANCHOR);
+	
+	if (list->map != NULL) return -1;
 	
 	p = list->head;
 	while (p->next) {
-		if (p->next == node) {
-			free_node = p->next;
-			p->next = free_node->next;
-			list->count--;
+		if (p->next == anchor && slist_share_mine(list, rank + 1)) {
+			SLIST_STAT_WALK(list, rank + 1);
 			
-			if (list->tail == free_node)  /* maintain tail pointer */
-				list->tail = p;
+			p = slist_share_own(list, p, rank, rank);
+			if (p == NULL) return -1;
 			
-			assert(list->tail->next == NULL);
+			new_node = slist_node_create(list, data);
+			if (new_node == NULL) return -1;
+			
+			assert(new_node != NULL);
+			
+			slist_link_after(list, p, rank, new_node);
 			
-			list->data_free(free_node->data);
-			free(free_node);
 			return 0;
 		}
 		p = p->next;
+		rank++;
 	}
+	SLIST_STAT_WALK(list, rank);
 	
-	return -1;
+	return -2;
 }
 
-SlistNode *remove_node_by_index(Slist *list, size_t index)
+int slist_add_data_next_node_safe  (Slist *list, SlistNode *anchor, void *data) // O(n)
 {
-	SlistNode *p = NULL, *ret_node = NULL;
-	
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(anchor != NULL);
 	
-	if (index >= list->count) return NULL;
-	
-	for(p = list->head; index > 0; index--, p = p->next);
-	
-	ret_node = p->next; 
-	p->next = ret_node->next;
-	list->count--;
+	if (list->map != NULL) return -1;
+	if (!slist_node_is_exist(list, anchor)) return -1;
 	
-	if (list->tail == ret_node)  /* maintain tail pointer */
-		list->tail = p;
-
-	assert(list->tail->next == NULL);
+	if (slist_add_data_next_node_unsafe(list, anchor, data) == -1) return -2;
 	
-	return ret_node;
+	return 0;
 }
 
-void *remove_data_by_index(Slist *list, size_t index)
+int slist_add_data_next_node_unsafe(Slist *list, SlistNode *anchor, void *data) // O(1)
 {
-	void *ret_data = NULL;
-	SlistNode *p = NULL, *free_node = NULL;
+	SlistNode *new_node = NULL;
 	
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(anchor != NULL);
 	
-	if (index >= list->count) return NULL;
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_ANCHOR);
 	
-	for(p = list->head; index > 0; index--, p = p->next);
+	if (list->map != NULL) return -1;
 	
-	free_node = p->next;
-	p->next = free_node->next;
-	list->count--;
+	anchor = slist_share_find(list, anchor);
+	if (anchor == NULL) return -1;
 	
-	if (list->tail == free_node)  /* maintain tail pointer */
-		list->tail = p;
-
-	assert(list->tail->next == NULL);
+	new_node = slist_node_create(list, data);
+	if (new_node == NULL) return -1;
 	
-	ret_data = free_node->data;
-	free(free_node);
+	assert(new_node != NULL);
 	
-	return ret_data;
+	slist_link_after(list, anchor, SLIST_RANK_UNKNOWN, new_node);
+	
+	return 0;
 }
 
-//get
-//get_nodeķһ㲻ȥdataģremoveժڵ㡣
-SlistNode *slist_get_node_by_index(Slist *list, size_t index)
+int slist_add_data_sorted(struct Slist *list, void *data) // O(n)
 {
-	SlistNode *p = NULL;
+	SlistNode *new_node = NULL;
 	
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(list->data_cmp != NULL);
 	
-	if (index >= list->count) return NULL;
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_SORTED);
 	
-	for (p = list->head->next; index > 0; index--, p = p->next);
+	if (list->map != NULL) return -1;
 	
-	return p;
+	new_node = slist_node_create(list, data);
+	if (new_node == NULL) return -1;
+	
+	assert(new_node != NULL);
+	
+	if (slist_add_node_sorted_internal(list, new_node) != 0) {
+		slist_node_release(list, new_node);
+		return -1;
+	}
+	
+	return 0;
 }
 
-SlistNode *slist_get_node_by_data(Slist *list, void *data)
+// add_node
+
+//һremove_one_by_nodeʹãժڵ㣬Ȼ롣
+//ûԽڵĲ룬removeժûкˡ
+
+static bool slist_node_is_exist(Slist *list, SlistNode *node)
 {
+	size_t i = 0;
 	SlistNode *p = NULL;
 	
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(node != NULL);
+	
+	if (slist_prefetch_ready(list)) { /* compares addresses only, no node is touched */
+		for (i = 0; i < list->count; i++) {
+			if (list->prefetch->nodes[i] == node) break;
+		}
+		SLIST_STAT_EXIST(list, i < list->count ? i + 1 : i);
+		return i < list->count;
+	}
 	
 	p = list->head->next;
 	while (p) {
-		if (list->data_equ(p->data, data)) return p;
+		if (p == node) break;
 		p = p->next;
+		i++;
 	}
+	SLIST_STAT_EXIST(list, p ? i + 1 : i);
 	
-	return NULL;
+	return p != NULL && slist_share_mine(list, i + 1);
 }
- 
-void *slist_get_data_by_index(Slist *list, size_t index)
+
+static void slist_add_node_first_internal(Slist *list, SlistNode *node)
 {
-	SlistNode *p = NULL;
-	
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(node != NULL);
 	
-	if (index >= list->count) return NULL;
-	
-	for (p = list->head->next; index > 0; index--, p = p->next);
+	slist_link_after(list, list->head, 0, node);
 	
-	return p->data;
+	return;
 }
 
-long slist_get_index_by_data(Slist *list, void *data)
+static void slist_add_node_last_internal(Slist *list, SlistNode *node)
 {
-	long index = 0;
-	SlistNode *p = NULL;
-	
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(node != NULL);
 	
-	p = list->head->next;
-	while (p) {
-		if (list->data_equ(p->data, data)) return index;
-		p = p->next;
-		index++;
+	if(list->tail == NULL) {
+		slist_add_node_first_internal(list, node);
+	} else {
+		slist_link_after(list, list->tail, list->count, node);
 	}
 	
-	return -1;
+	assert(list->tail->next == NULL);
+	
+	return;
 }
 
-long slist_get_index_by_node(Slist *list, SlistNode *node)
+//ǰnodeС
+int slist_add_node_first(Slist *list, SlistNode *node)
 {
-	long index = 0;
-	SlistNode *p = NULL;
-	
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(node != NULL);
 	
-	p = list->head->next;
-	while (p) {
-		if (p == node) return index;
-		p = p->next;
-		index++;
-	}
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_FIRST);
 	
-	return -1;
+	if (list->map != NULL) return -1;
+	if (slist_node_is_exist(list, node)) return -1;
+	
+	slist_add_node_first_internal(list, node);
+	
+	return 0;
 }
 
-SlistNode *slist_get_node_custom(Slist *list, SlistDataFind *data_find, void *user_data)
+//ǰnodeС
+int slist_add_node_last(Slist *list, SlistNode *node)
+{
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(node != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_LAST);
+	
+	if (list->map != NULL) return -1;
+	if (slist_node_is_exist(list, node)) return -1;
+	if (slist_unshare(list) != 0) return -1;
+	
+	slist_add_node_last_internal(list, node);
+	
+	return 0;
+}
+
+int slist_add_node_prev_node(Slist *list, SlistNode *anchor, SlistNode *node)
 {
+	size_t rank = 0;
 	SlistNode *p = NULL;
 	
 	assert(list != NULL);
 	assert(list->head != NULL);
-	assert(data_find != NULL);
+	assert(anchor != NULL);
+	assert(node != NULL);
 	
-	p = list->head->next;
-	while (p) {
-		if (data_find(p->data, user_data) == 0) break;
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_ANCHOR);
+	
+	if (list->map != NULL) return -1;
+	if (slist_node_is_exist(list, node)) return -1;
+	
+	p = list->head;
+	while (p->next) {
+		if (p->next == anchor && slist_share_mine(list, rank + 1)) {
+			SLIST_STAT_WALK(list, rank + 1);
+			p = slist_share_own(list, p, rank, rank);
+			if (p == NULL) return -1;
+			slist_link_after(list, p, rank, node);
+			return 0;
+		}
 		p = p->next;
+		rank++;
 	}
+	SLIST_STAT_WALK(list, rank);
 	
-	return p;
+	return -1;	 
 }
 
-// last --- O(n) or O(1) -- ok
-SlistNode *slist_last_node(Slist *list)
+//ȡanchorһʹgetȡ֤anchorС
+int slist_add_node_next_node(Slist *list,  SlistNode *anchor,  SlistNode *node)
 {
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(anchor != NULL);
+	assert(node != NULL);
 	
-	return list->tail;
+	if (list->map != NULL) return -1;
+	if (!slist_node_is_exist(list, anchor)) return -1;
+	
+	if (slist_add_node_next_node_unsafe(list, anchor, node) == -1) return -2;
+	
+	return 0;
 }
 
-void *slist_last_data(Slist *list)
+int slist_add_node_next_node_unsafe(Slist *list,  SlistNode *anchor,  SlistNode *node)
 {
-	void *ret_data = NULL;
-	
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(anchor != NULL);
+	assert(node != NULL);
 	
-	if (list->tail != NULL) 
-		ret_data = list->tail->data;
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_ANCHOR);
 	
-	return ret_data;
+	if (list->map != NULL) return -1;
+	if (slist_node_is_exist(list, node)) return -1;
+	
+	anchor = slist_share_find(list, anchor);
+	if (anchor == NULL) return -1;
+	
+	slist_link_after(list, anchor, SLIST_RANK_UNKNOWN, node);
+	
+	return 0;
 }
 
-// first --- O(1) -- ok
-SlistNode *slist_first_node(Slist *list)
+int slist_add_node_sorted(Slist *list, SlistNode *node)
 {
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(list->data_cmp != NULL);
+	assert(node != NULL);
 	
-	return list->head->next;
+	SLIST_STAT_CALL(list, SLIST_OP_ADD_SORTED);
+	
+	if (list->map != NULL) return -1;
+	if (slist_node_is_exist(list, node)) return -1;
+	
+	return slist_add_node_sorted_internal(list, node);
 }
 
-void *slist_first_data(Slist *list)
+/* insert after the last node not greater than node, equal keys keep insertion order. 
+   -1 when a shared list cannot copy its nodes up to there */
+static int slist_add_node_sorted_internal(Slist *list, SlistNode *node)
 {
-	void *ret_data = NULL;
+	size_t rank = 0, visited = 0;
+	struct SlistIndexTower *tower = NULL;
+	SlistNode *p = NULL;
+	int k = 0;
 	
 	assert(list != NULL);
 	assert(list->head != NULL);
+	assert(node != NULL);
 	
-	if (list->head->next != NULL) 
-		ret_data = list->head->next->data;
+	p = list->head;
+	if (list->sorted && slist_index_ready(list)) { /* towers in rank order are in key order */
+		tower = list->index->header;
+		for (k = list->index->level - 1; k >= 0; k--) {
+			while (tower->link[k].next && list->data_cmp(tower->link[k].next->node->data, node->data) <= 0) {
+				rank += tower->link[k].span;
+				tower = tower->link[k].next;
+				visited++;
+			}
+		}
+		p = tower->node;
+	}
 	
-	return ret_data;
+	while (p->next && list->data_cmp(p->next->data, node->data) <= 0) {
+		p = p->next;
+		rank++;
+		visited++;
+	}
+	SLIST_STAT_WALK(list, p->next ? visited + 1 : visited);
+	
+	p = slist_share_own(list, p, rank, rank);
+	if (p == NULL) return -1;
+	
+	slist_link_after(list, p, rank, node);
+	
+	return 0;
 }
 
 
-//advanced method
+// remove --- !!! -- O(n)
+int remove_one_by_data(struct Slist *list, void *data)
+{
+	size_t rank = 0, n = 0;
+	struct SlistPrefetch *prefetch = NULL;
+	SlistNode *p = NULL, *free_node = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_REMOVE_BY_DATA);
+	
+	if (list->map != NULL) return -1;
+	
+	if (slist_hash_ready(list)) {
+		p = slist_hash_find_prev(list, data);
+		if (p == NULL) return -1;
+		
+		free_node = slist_unlink_after(list, p, SLIST_RANK_UNKNOWN);
+		
+		if (list->data_free) list->data_free(free_node->data); 
+		slist_node_release(list, free_node);
+		return 0;
+	}
+	
+	if (slist_prefetch_ready(list)) {
+		prefetch = list->prefetch;
+		for (rank = 0, n = list->count; rank < n; rank++) {
+			slist_prefetch_ahead(prefetch, rank, n);
+			if (!list->data_equ(prefetch->nodes[rank]->data, data)) continue;
+			
+			SLIST_STAT_WALK(list, rank + 1);
+			p = rank ? prefetch->nodes[rank - 1] : list->head;
+			free_node = slist_unlink_after(list, p, rank);
+			slist_prefetch_erase(list, rank);
+			
+			if (list->data_free) list->data_free(free_node->data); 
+			slist_node_release(list, free_node);
+			return 0;
+		}
+		SLIST_STAT_WALK(list, n);
+		return -1;
+	}
+	
+	p = list->head;
+	while (p->next) {
+		if (list->data_equ(p->next->data, data)) {
+			SLIST_STAT_WALK(list, rank + 1);
+			p = slist_share_own(list, p, rank, rank + 1);
+			if (p == NULL) return -2;
+			
+			free_node = slist_unlink_after(list, p, rank);
+			
+			if (list->data_free) list->data_free(free_node->data); 
+			slist_node_release(list, free_node);
+			return 0;
+		}
+		p = p->next;
+		rank++;
+	}
+	SLIST_STAT_WALK(list, rank);
+	
+	return -1;
+}
 
-// reverse --- O(n)
-void slist_reverse(struct Slist *list)
+int remove_all_by_data(struct Slist *list, void *data)
 {
-	SlistNode *p = NULL;
+	int ret = -1;
+	size_t rank = 0, i = 0, n = 0;
+	void *copy_data = NULL;
+	struct SlistPrefetch *prefetch = NULL;
+	SlistNode *p = NULL, *free_node = NULL;
 	
 	assert(list != NULL);
 	assert(list->head != NULL);
 	
-	list->tail = list->head->next;
-	while (list->tail->next) {
-		p = list->tail->next;
-		list->tail->next = p->next;
+	SLIST_STAT_CALL(list, SLIST_OP_REMOVE_BY_DATA);
+	
+	if (list->map != NULL) return -1;
+	
+	copy_data = data;
+	if (list->data_size) { /* data may sit in a node about to go */
+		if (!slist_scratch_reserve(list, 1)) return -1;
+		copy_data = memcpy(list->scratch, data, list->data_size);
+	} else if (list->data_copy && list->data_free) { /* data may be freed below, must copy data !!! */
+		copy_data = list->data_copy(data);
+	}
+	
+	if (slist_hash_ready(list)) {
+		while ((p = slist_hash_find_prev(list, copy_data)) != NULL) {
+			free_node = slist_unlink_after(list, p, SLIST_RANK_UNKNOWN);
+			
+			if (list->data_free) list->data_free(free_node->data); 
+			slist_node_release(list, free_node);
+			
+			ret = 0;
+		}
+		if (copy_data != data && !list->data_size) list->data_free(copy_data); /* must free copy_data !!! */
 		
-		p->next = list->head->next;
-		list->head->next = p;
+		return ret;
 	}
 	
-	return;
+	if (slist_prefetch_ready(list)) { /* survivors are packed to the front of the table */
+		prefetch = list->prefetch;
+		p = list->head;
+		for (i = 0, n = list->count; i < n; i++) {
+			slist_prefetch_ahead(prefetch, i, n);
+			if (list->data_equ(prefetch->nodes[i]->data, copy_data)) {
+				free_node = slist_unlink_after(list, p, rank);
+				
+				if (list->data_free) list->data_free(free_node->data); 
+				slist_node_release(list, free_node);
+				
+				ret = 0;
+				continue;
+			}
+			p = prefetch->nodes[rank++] = prefetch->nodes[i];
+		}
+		prefetch->stale = false;
+		SLIST_STAT_WALK(list, n);
+		if (copy_data != data && !list->data_size) list->data_free(copy_data); /* must free copy_data !!! */
+		
+		return ret;
+	}
+	
+	n = list->count;
+	p = list->head;
+	while (p->next) {
+		if (list->data_equ(p->next->data, copy_data)) {
+			p = slist_share_own(list, p, rank, rank + 1);
+			if (p == NULL) {
+				ret = -2;
+				break;
+			}
+			
+			free_node = slist_unlink_after(list, p, rank);
+			
+			if (list->data_free) list->data_free(free_node->data); 
+			slist_node_release(list, free_node);
+			
+			ret = 0;
+			continue;
+		}
+		p = p->next;
+		rank++;
+	}
+	SLIST_STAT_WALK(list, n);
+	if (copy_data != data && !list->data_size) list->data_free(copy_data); /* must free copy_data !!! */
+	
+	return ret;
 }
 
-// sort --- !!!
-void slist_sort(struct Slist *list);
+int remove_by_node(struct Slist *list, SlistNode *node)
+{
+	size_t rank = 0;
+	SlistNode *p = NULL, *free_node = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(node != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_REMOVE_BY_NODE);
+	
+	if (list->map != NULL) return -1;
+	
+	p = list->head;
+	while (p->next) {
+		if (p->next == node && slist_share_mine(list, rank + 1)) {
+			SLIST_STAT_WALK(list, rank + 1);
+			p = slist_share_own(list, p, rank, rank + 1);
+			if (p == NULL) return -2;
+			
+			free_node = slist_unlink_after(list, p, rank);
+			
+			if (list->data_free) list->data_free(free_node->data);
+			slist_node_release(list, free_node);
+			return 0;
+		}
+		p = p->next;
+		rank++;
+	}
+	SLIST_STAT_WALK(list, rank);
+	
+	return -1;
+}
 
-//sort merge
-void slist_sort_merge(Slist *list1, Slist *list2);
+SlistNode *remove_node_by_index(Slist *list, size_t index)
+{
+	SlistNode *p = NULL, *ret_node = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_REMOVE_BY_INDEX);
+	
+	if (list->map != NULL) return NULL;
+	if (index >= list->count) return NULL;
+	
+	p = slist_share_at_rank(list, index, index + 1);
+	if (p == NULL) return NULL;
+	
+	ret_node = slist_unlink_after(list, p, index);
+	ret_node->next = NULL;
+	
+	return ret_node;
+}
 
-//free list,append list to target.
-void slist_concat(Slist *target, Slist *list)
+void *remove_data_by_index(Slist *list, size_t index)
 {
-	SlistNode *p = NULL;
+	void *ret_data = NULL;
+	SlistNode *p = NULL, *free_node = NULL;
 	
-	assert(target != NULL);
-	assert(target->head != NULL);
 	assert(list != NULL);
 	assert(list->head != NULL);
 	
-	while (list->head->next) {
-		p = list->head->next;
-		list->head->next = p->next;
-		list->count--;
-		
-		slist_add_node_last(target, p);
+	SLIST_STAT_CALL(list, SLIST_OP_REMOVE_BY_INDEX);
+	
+	if (list->map != NULL) return NULL;
+	if (index >= list->count) return NULL;
+	if (!slist_scratch_reserve(list, 1)) return NULL;
+	
+	p = slist_share_at_rank(list, index, index + 1);
+	if (p == NULL) return NULL;
+	
+	free_node = slist_unlink_after(list, p, index);
+	
+	ret_data = slist_node_take_data(list, free_node, 0);
+	slist_node_release(list, free_node);
+	
+	return ret_data;
+}
+
+//pop up to n data from the front into data[], one pass. returns the number popped.
+size_t remove_data_first_batch(Slist *list, void **data, size_t n)
+{
+	size_t i = 0;
+	SlistNode *node = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(data != NULL || n == 0);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_REMOVE_BY_INDEX);
+	
+	if (list->map != NULL) return 0;
+	if (n > list->count) n = list->count;
+	if (!slist_scratch_reserve(list, n)) return 0;
+	if (slist_share_own(list, list->head, 0, n) == NULL) return 0;
+	
+	if (slist_has_side_index(list)) {
+		for (i = 0; i < n; i++) {
+			node = slist_unlink_after(list, list->head, 0);
+			data[i] = slist_node_take_data(list, node, i);
+			slist_node_release(list, node);
+		}
+		return n;
 	}
 	
-	assert(list->count == 0);
+	for (i = 0; i < n; i++) {
+		node = list->head->next;
+		list->head->next = node->next;
+		data[i] = slist_node_take_data(list, node, i);
+		slist_node_release(list, node);
+	}
+	list->count -= n;
 	
-	slist_destroy(list);
+	if (list->count == 0) /* maintain tail pointer */
+		list->tail = NULL;
 	
-	return;
+	if (list->source != NULL) { /* the n nodes were the list's own */
+		list->share_rank -= n;
+		if (list->share_rank == 0) list->share_prev = list->head;
+	}
+	
+	slist_relinked(list);
+	
+	return n;
 }
 
+//indexes must be ascending and refer to positions before any removal, 
+//removed data go to data[] in the same order, one pass. 
+//returns the number removed, stops at the first index out of range.
+size_t remove_data_by_index_batch(Slist *list, const size_t *indexes, size_t n, void **data)
+{
+	size_t i = 0, pos = 0;
+	SlistNode *p = NULL, *free_node = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(indexes != NULL || n == 0);
+	assert(data != NULL || n == 0);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_REMOVE_BY_INDEX);
+	
+	if (list->map != NULL) return 0;
+	if (!slist_scratch_reserve(list, n)) return 0;
+	
+	p = list->head;
+	for (i = 0; i < n; i++) {
+		assert(i == 0 || indexes[i] > indexes[i - 1]);
+		
+		/* pos is the original index of p->next, i nodes are already gone */
+		for (; pos < indexes[i] && p->next; pos++) p = p->next;
+		if (p->next == NULL) break;
+		
+		p = slist_share_own(list, p, pos - i, pos - i + 1);
+		if (p == NULL) break;
+		
+		free_node = slist_unlink_after(list, p, pos - i);
+		data[i] = slist_node_take_data(list, free_node, i);
+		slist_node_release(list, free_node);
+		pos++;
+	}
+	SLIST_STAT_WALK(list, pos);
+	
+	return i;
+}
 
+//get
+//get_nodeķһ㲻ȥdataģremoveժڵ㡣
+SlistNode *slist_get_node_by_index(Slist *list, size_t index)
+{
+	SlistNode *p = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_GET_BY_INDEX);
+	
+	if (index >= list->count) return NULL;
+	if (list->map != NULL && !slist_map_nodes(list)) return NULL;
+	if (list->source != NULL) return slist_share_at_rank(list, index + 1, index + 1);
+	
+	p = slist_node_at_rank(list, index + 1);
+	
+	return p;
+}
+
+SlistNode *slist_get_node_by_data(Slist *list, void *data)
+{
+	size_t i = 0;
+	SlistNode *p = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_GET_BY_DATA);
+	
+	if (list->map != NULL && !slist_map_nodes(list)) return NULL;
+	
+	if (slist_hash_ready(list)) {
+		p = slist_hash_find_prev(list, data);
+		return p ? p->next : NULL;
+	}
+	
+	if (slist_prefetch_ready(list)) {
+		for (i = 0; i < list->count; i++) {
+			slist_prefetch_ahead(list->prefetch, i, list->count);
+			if (list->data_equ(list->prefetch->nodes[i]->data, data)) break;
+		}
+		SLIST_STAT_WALK(list, i < list->count ? i + 1 : i);
+		return i < list->count ? list->prefetch->nodes[i] : NULL;
+	}
+	
+	p = list->head->next;
+	while (p) {
+		if (list->data_equ(p->data, data)) break;
+		p = p->next;
+		i++;
+	}
+	SLIST_STAT_WALK(list, p ? i + 1 : i);
+	
+	if (p != NULL && list->source != NULL) /* hand out the list's own node */
+		p = slist_share_own(list, p, i + 1, i + 1);
+	
+	return p;
+}
+ 
+void *slist_get_data_by_index(Slist *list, size_t index)
+{
+	SlistNode *p = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_GET_BY_INDEX);
+	
+	if (index >= list->count) return NULL;
+	if (list->map != NULL) return list->map->records + index * list->map->stride;
+	
+	p = slist_node_at_rank(list, index + 1);
+	
+	return p->data;
+}
+
+long slist_get_index_by_data(Slist *list, void *data)
+{
+	long index = 0;
+	size_t i = 0;
+	SlistNode *p = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_GET_BY_DATA);
+	
+	/* a miss is O(1), a hit still has to count its way from the head */
+	if (slist_hash_ready(list) && slist_hash_find_prev(list, data) == NULL) return -1;
+	
+	if (slist_prefetch_ready(list)) {
+		for (i = 0; i < list->count; i++) {
+			slist_prefetch_ahead(list->prefetch, i, list->count);
+			if (list->data_equ(list->prefetch->nodes[i]->data, data)) break;
+		}
+		SLIST_STAT_WALK(list, i < list->count ? i + 1 : i);
+		return i < list->count ? (long)i : -1;
+	}
+	
+	if (list->map != NULL) {
+		for (i = 0; i < list->count; i++) {
+			if (list->data_equ(list->map->records + i * list->map->stride, data)) break;
+		}
+		SLIST_STAT_WALK(list, i < list->count ? i + 1 : i);
+		return i < list->count ? (long)i : -1;
+	}
+	
+	p = list->head->next;
+	while (p) {
+		if (list->data_equ(p->data, data)) break;
+		p = p->next;
+		index++;
+	}
+	SLIST_STAT_WALK(list, p ? (size_t)index + 1 : (size_t)index);
+	
+	return p ? index : -1;
+}
+
+long slist_get_index_by_node(Slist *list, SlistNode *node)
+{
+	long index = 0;
+	size_t i = 0;
+	SlistNode *p = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_GET_BY_NODE);
+	
+	if (slist_prefetch_ready(list)) { /* compares addresses only, no node is touched */
+		for (i = 0; i < list->count; i++) {
+			if (list->prefetch->nodes[i] == node) break;
+		}
+		SLIST_STAT_WALK(list, i < list->count ? i + 1 : i);
+		return i < list->count ? (long)i : -1;
+	}
+	
+	p = list->head->next;
+	while (p) {
+		if (p == node) break;
+		p = p->next;
+		index++;
+	}
+	SLIST_STAT_WALK(list, p ? (size_t)index + 1 : (size_t)index);
+	
+	return p && slist_share_mine(list, (size_t)index + 1) ? index : -1;
+}
+
+SlistNode *slist_get_node_custom(Slist *list, SlistDataFind *data_find, void *user_data)
+{
+	size_t i = 0;
+	SlistNode *p = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(data_find != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_GET_BY_DATA);
+	
+	if (list->map != NULL && !slist_map_nodes(list)) return NULL;
+	
+	if (slist_prefetch_ready(list)) {
+		for (i = 0; i < list->count; i++) {
+			slist_prefetch_ahead(list->prefetch, i, list->count);
+			if (data_find(list->prefetch->nodes[i]->data, user_data) == 0) break;
+		}
+		SLIST_STAT_WALK(list, i < list->count ? i + 1 : i);
+		return i < list->count ? list->prefetch->nodes[i] : NULL;
+	}
+	
+	p = list->head->next;
+	while (p) {
+		if (data_find(p->data, user_data) == 0) break;
+		p = p->next;
+		i++;
+	}
+	SLIST_STAT_WALK(list, p ? i + 1 : i);
+	
+	if (p != NULL && list->source != NULL) /* hand out the list's own node */
+		p = slist_share_own(list, p, i + 1, i + 1);
+	
+	return p;
+}
+
+// last --- O(n) or O(1) -- ok
+SlistNode *slist_last_node(Slist *list)
+{
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	if (list->source != NULL) return slist_share_at_rank(list, list->count, list->count);
+	if (list->map != NULL && !slist_map_nodes(list)) return NULL;
+	
+	return list->tail;
+}
+
+void *slist_last_data(Slist *list)
+{
+	void *ret_data = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	if (list->tail != NULL) 
+		ret_data = list->tail->data;
+	else if (list->map != NULL && list->count > 0) 
+		ret_data = list->map->records + (list->count - 1) * list->map->stride;
+	
+	return ret_data;
+}
+
+// first --- O(1) -- ok
+SlistNode *slist_first_node(Slist *list)
+{
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	if (list->source != NULL) return slist_share_at_rank(list, 1, 1);
+	if (list->map != NULL && !slist_map_nodes(list)) return NULL;
+	
+	return list->head->next;
+}
+
+void *slist_first_data(Slist *list)
+{
+	void *ret_data = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	if (list->head->next != NULL) 
+		ret_data = list->head->next->data;
+	else if (list->map != NULL && list->count > 0) 
+		ret_data = list->map->records;
+	
+	return ret_data;
+}
+
+
+//advanced method
+
+// reverse --- O(n)
+int slist_reverse(struct Slist *list)
+{
+	size_t i = 0, j = 0, d = 0;
+	SlistNode *p = NULL, **nodes = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_REVERSE);
+	
+	if (list->map != NULL) return -1;
+	if (list->count < 2) return 0;
+	if (slist_unshare(list) != 0) return -1;
+	
+	SLIST_STAT_WALK(list, list->count);
+	
+	list->sorted = false;
+	
+	if (slist_prefetch_ready(list)) { /* relink back to front, then flip the table */
+		nodes = list->prefetch->nodes;
+		d = list->prefetch->distance;
+		
+		slist_relinked(list);
+		
+		list->head->next = nodes[list->count - 1];
+		for (i = list->count - 1; i > 0; i--) {
+			if (i >= d) SLIST_PREFETCH_WRITE(nodes[i - d]);
+			nodes[i]->next = nodes[i - 1];
+		}
+		nodes[0]->next = NULL;
+		list->tail = nodes[0];
+		
+		for (i = 0, j = list->count - 1; i < j; i++, j--) {
+			p = nodes[i];
+			nodes[i] = nodes[j];
+			nodes[j] = p;
+		}
+		list->prefetch->stale = false;
+		
+		return 0;
+	}
+	
+	slist_relinked(list);
+	
+	list->tail = list->head->next;
+	while (list->tail->next) {
+		p = list->tail->next;
+		list->tail->next = p->next;
+		
+		p->next = list->head->next;
+		list->head->next = p;
+	}
+	
+	return 0;
+}
+
+// sort --- O(nlogn)
+/* merge two NULL terminated sorted chains, on equal keys a goes first */
+static SlistNode *slist_merge_nodes(SlistDataCmp *data_cmp, SlistNode *a, SlistNode *b)
+{
+	SlistNode merged, *p = &merged;
+	
+	assert(data_cmp != NULL);
+	
+	while (a && b) {
+		if (data_cmp(a->data, b->data) <= 0) {
+			p->next = a;
+			a = a->next;
+		} else {
+			p->next = b;
+			b = b->next;
+		}
+		p = p->next;
+	}
+	p->next = a ? a : b;
+	
+	return merged.next;
+}
+
+/* bottom-up and stable: runs[i] holds a sorted run of 2^i nodes, every new 
+   node is carried up like a binary counter, nodes are relinked in place */
+int slist_sort(struct Slist *list)
+{
+	SlistNode *runs[sizeof(size_t) * 8 + 1] = {NULL};
+	SlistNode *p = NULL, *next = NULL, *carry = NULL;
+	size_t i = 0, max_run = 0;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(list->data_cmp != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_SORT);
+	
+	if (list->map != NULL) return -1;
+	if (list->count < 2) return 0;
+	if (slist_unshare(list) != 0) return -1;
+	
+	SLIST_STAT_WALK(list, list->count);
+	
+	p = list->head->next;
+	while (p) {
+		next = p->next;
+		p->next = NULL;
+		
+		carry = p;
+		for (i = 0; runs[i] != NULL; i++) { /* runs[i] holds the earlier nodes */
+			carry = slist_merge_nodes(list->data_cmp, runs[i], carry);
+			runs[i] = NULL;
+		}
+		runs[i] = carry;
+		if (i > max_run) max_run = i;
+		
+		p = next;
+	}
+	
+	carry = NULL;
+	for (i = 0; i <= max_run; i++) {
+		if (runs[i] != NULL) 
+			carry = slist_merge_nodes(list->data_cmp, runs[i], carry);
+	}
+	
+	list->head->next = carry;
+	
+	for (p = carry; p->next; p = p->next); /* maintain tail pointer */
+	list->tail = p;
+	
+	slist_relinked(list);
+	
+	return 0;
+}
+
+//sort merge
+//list1 and list2 must be sorted, list2's nodes are merged into list1 and list2 is freed. O(n+m)
+//on different pools list2's nodes are copied into list1's first
+int slist_sort_merge(Slist *list1, Slist *list2)
+{
+	SlistNode *p = NULL;
+	
+	assert(list1 != NULL);
+	assert(list1->head != NULL);
+	assert(list2 != NULL);
+	assert(list2->head != NULL);
+	assert(list1->data_cmp != NULL);
+	
+	SLIST_STAT_CALL(list1, SLIST_OP_SORT);
+	
+	/* list2 is kept on every failure */
+	if (list1->map != NULL || list2->map != NULL) return -1;
+	if (list1->intrusive != list2->intrusive || list1->data_size != list2->data_size) return -1;
+	if (slist_unshare(list1) != 0 || slist_unshare(list2) != 0) return -1;
+	if (list1->pool != list2->pool && slist_nodes_rehome(list2, list1) != 0) return -1;
+	
+	if (list2->count > 0) {
+		list1->head->next = slist_merge_nodes(list1->data_cmp, list1->head->next, list2->head->next);
+		list1->count += list2->count;
+		SLIST_STAT_LENGTH(list1);
+		SLIST_STAT_WALK(list1, list1->count);
+		
+		/* the tail is the tail of whichever list ran out last */
+		p = list1->tail;
+		if (p == NULL || list1->data_cmp(p->data, list2->tail->data) <= 0)
+			p = list2->tail;
+		list1->tail = p;
+		
+		list2->head->next = NULL;
+		list2->tail = NULL;
+		list2->count = 0;
+		
+		slist_relinked(list1);
+	}
+	
+	assert(list1->tail == NULL || list1->tail->next == NULL);
+	
+	slist_destroy(list2);
+	
+	return 0;
+}
+
+//move every node of list to the end of target, list is left empty. O(1) on
+//the same pool, O(m) otherwise: the nodes are copied into target's allocator
+int slist_splice(Slist *target, Slist *list)
+{
+	assert(target != NULL);
+	assert(target->head != NULL);
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(target != list);
+	
+	if (target->map != NULL || list->map != NULL) return -1;
+	if (target->intrusive != list->intrusive || target->data_size != list->data_size) return -1;
+	if (list->count == 0) return 0;
+	/* target's tail is written, a lazy copy's shared nodes are not its to give */
+	if (slist_unshare(target) != 0) return -1;
+	if (list->source != NULL && slist_unshare(list) != 0) return -1;
+	if (target->pool != list->pool && slist_nodes_rehome(list, target) != 0) return -1;
+	
+	if (target->sorted && !list->sorted) 
+		target->sorted = false;
+	if (target->sorted) /* both in order, only the seam can break it */
+		slist_sorted_check(target, target->tail ? target->tail : target->head, list->head->next, list->head->next);
+	
+	if (target->tail) 
+		target->tail->next = list->head->next;
+	else 
+		target->head->next = list->head->next;
+	target->tail = list->tail;
+	target->count += list->count;
+	SLIST_STAT_LENGTH(target);
+	
+	list->head->next = NULL;
+	list->tail = NULL;
+	list->count = 0;
+	
+	slist_share_adopt(target, list); /* views of list read target's last nodes now */
+	
+	slist_relinked(target);
+	slist_relinked(list);
+	
+	return 0;
+}
+
+//free list,append list to target. O(1) on the same pool, see slist_splice
+int slist_concat(Slist *target, Slist *list)
+{
+	assert(target != NULL);
+	assert(target->head != NULL);
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	if (target->map != NULL || list->map != NULL) return -1;
+	if (slist_splice(target, list) != 0) return -1; /* list is kept */
+	
+	assert(list->count == 0);
+	
+	slist_destroy(list);
+	
+	return 0;
+}
+
+/* copies of the nodes from first on, taken from target's allocator, for 
+   lists on different pools. NULL when out of memory, none is kept */
+static SlistNode *slist_nodes_copy(Slist *target, SlistNode *first, SlistNode **last)
+{
+	SlistNode *copy = NULL, *node = NULL, *next = NULL, *p = NULL;
+	
+	assert(target != NULL);
+	assert(first != NULL);
+	assert(last != NULL);
+	
+	for (p = first; p; p = p->next) {
+		node = slist_node_create(target, p->data);
+		if (node == NULL) {
+			for (node = copy; node; node = next) {
+				next = node->next;
+				slist_node_release(target, node);
+			}
+			return NULL;
+		}
+		if (copy) (*last)->next = node; else copy = node;
+		*last = node;
+	}
+	
+	return copy;
+}
+
+/* list's nodes are replaced by copies from target's allocator so they can
+   be linked into target. O(m), -1 when out of memory and list is kept */
+static int slist_nodes_rehome(Slist *list, Slist *target)
+{
+	SlistNode *first = NULL, *last = NULL;
+	size_t count = list->count;
+	
+	assert(list->source == NULL);
+	
+	if (count == 0) return 0;
+	
+	first = slist_nodes_copy(target, list->head->next, &last);
+	if (first == NULL) return -1;
+	
+	slist_nodes_release_all(list); /* the data live on in the copies */
+	
+	list->head->next = first;
+	list->tail = last;
+	list->count = count;
+	SLIST_STAT_LENGTH(list);
+	
+	return 0;
+}
+
+/* the nodes after prev, which is at rank, go to a new list */
+static Slist *slist_split_after(Slist *list, SlistNode *prev, size_t rank)
+{
+	Slist *new_list = NULL;
+	
+	assert(list != NULL);
+	assert(prev != NULL);
+	
+	new_list = slist_create_pool(list->data_cmp, 
+	                             list->data_equ, 
+	                             list->data_copy, 
+	                             list->data_free,
+	                             list->pool);
+	if (new_list == NULL) return NULL;
+	
+	new_list->intrusive = list->intrusive;
+	new_list->data_free_batch = list->data_free_batch;
+	new_list->sorted = list->sorted;
+	
+	if (prev->next == NULL) return new_list;
+	
+	new_list->head->next = prev->next;
+	new_list->tail = list->tail;
+	new_list->count = list->count - rank;
+	SLIST_STAT_LENGTH(new_list);
+	
+	if (list->source != NULL) { /* prev is the list's own, every shared node goes along */
+		new_list->share_prev = list->share_prev == prev ? new_list->head : list->share_prev;
+		new_list->share_rank = list->share_rank - rank;
+		slist_share_join(new_list, list->source);
+		slist_share_leave(list);
+	}
+	slist_share_adopt(new_list, list); /* views read nothing before prev */
+	
+	prev->next = NULL;
+	list->tail = (prev == list->head) ? NULL : prev;
+	list->count = rank;
+	
+	slist_relinked(list);
+	
+	return new_list;
+}
+
+//nodes from index on move to the returned list. O(n), O(logn) with index
+Slist *slist_split_at_index(Slist *list, size_t index)
+{
+	SlistNode *p = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_SPLIT);
+	
+	if (list->map != NULL) return NULL;
+	if (index > list->count) return NULL;
+	
+	p = slist_share_at_rank(list, index, index);
+	if (p == NULL) return NULL;
+	
+	return slist_split_after(list, p, index);
+}
+
+//nodes after node move to the returned list, NULL if node is not in list. O(n)
+Slist *slist_split_at_node(Slist *list, SlistNode *node)
+{
+	size_t rank = 0;
+	SlistNode *p = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(node != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_SPLIT);
+	
+	if (list->map != NULL) return NULL;
+	
+	for (p = list->head->next, rank = 1; p; p = p->next, rank++) {
+		if (p == node && slist_share_mine(list, rank)) {
+			SLIST_STAT_WALK(list, rank);
+			p = slist_share_own(list, node, rank, rank);
+			return p ? slist_split_after(list, p, rank) : NULL;
+		}
+	}
+	SLIST_STAT_WALK(list, list->count);
+	
+	return NULL;
+}
+
+// sorted mode --- kept by the link paths, ended by the first edit out of order
+int slist_sorted_enable(Slist *list)
+{
+	SlistNode *p = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(list->data_cmp != NULL);
+	
+	if (list->map != NULL) return -1;
+	if (list->sorted) return 0;
+	
+	/* a list already in order is not relinked, its side structures stay */
+	for (p = list->head->next; p && p->next; p = p->next) {
+		if (list->data_cmp(p->data, p->next->data) > 0) break;
+	}
+	SLIST_STAT_WALK(list, list->count);
+	
+	if (p && p->next && slist_sort(list) != 0) return -1;
+	
+	list->sorted = true;
+	
+	return 0;
+}
+
+void slist_sorted_disable(Slist *list)
+{
+	assert(list != NULL);
+	
+	list->sorted = false;
+	
+	return;
+}
+
+bool slist_issorted(Slist *list)
+{
+	assert(list != NULL);
+	
+	return list->sorted;
+}
+
+/* nodes first to last were just linked after prev, the mode ends unless they
+   and their new neighbours are in order */
+static void slist_sorted_check(Slist *list, SlistNode *prev, SlistNode *first, SlistNode *last)
+{
+	SlistNode *p = NULL;
+	
+	assert(list != NULL);
+	assert(list->sorted);
+	
+	if (prev != list->head && list->data_cmp(prev->data, first->data) > 0) goto broken;
+	for (p = first; p != last; p = p->next) {
+		if (list->data_cmp(p->data, p->next->data) > 0) goto broken;
+	}
+	if (last->next && list->data_cmp(last->data, last->next->data) > 0) goto broken;
+	
+	return;
+	
+broken:
+	list->sorted = false;
+	
+	return;
+}
+
+/* search probed by its prefetch table when the other side has count nodes */
+static bool slist_sorted_gallop(Slist *probed, size_t count)
+{
+	assert(probed != NULL);
+	
+	if (probed->prefetch == NULL) return false;
+	if (probed->count / SLIST_GALLOP_RATIO < count) return false;
+	
+	return slist_prefetch_ready(probed);
+}
+
+/* first i in [from, n) whose data is not less than data, n if none. steps of
+   1, 2, 4 ... from from, then a binary search inside the last step */
+static size_t slist_sorted_seek(SlistDataCmp *data_cmp, SlistNode **nodes, size_t from, size_t n, void *data)
+{
+	size_t lo = from, hi = from, step = 1, mid = 0;
+	
+	while (hi < n && data_cmp(nodes[hi]->data, data) < 0) {
+		lo = hi + 1;
+		hi += step;
+		step <<= 1;
+	}
+	if (hi > n) hi = n;
+	
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (data_cmp(nodes[mid]->data, data) < 0) 
+			lo = mid + 1;
+		else 
+			hi = mid;
+	}
+	
+	return lo;
+}
+
+//list2's nodes not in list1 are relinked into list1 in one merge pass. O(n+m)
+long slist_sorted_union(Slist *list1, Slist *list2)
+{
+	size_t moved = 0, visited = 0, i = 0, last_i = 0, n1 = 0;
+	SlistNode **nodes1 = NULL, *prev1 = NULL, *prev2 = NULL, *next1 = NULL, *x = NULL;
+	SlistNode *spare = NULL, *copy = NULL, *last = NULL;
+	
+	assert(list1 != NULL);
+	assert(list1->head != NULL);
+	assert(list2 != NULL);
+	assert(list2->head != NULL);
+	assert(list1 != list2);
+	assert(list1->sorted && list2->sorted);
+	
+	SLIST_STAT_CALL(list1, SLIST_OP_SET);
+	
+	if (list1->map != NULL || list2->map != NULL) return -1;
+	if (list1->intrusive != list2->intrusive || list1->data_size != list2->data_size) return -1;
+	if (list2->count == 0) return 0;
+	if (slist_unshare(list1) != 0 || slist_unshare(list2) != 0) return -1;
+	if (list1->pool != list2->pool) { /* a copy in list1's allocator per node of list2 */
+		spare = slist_nodes_copy(list1, list2->head->next, &last);
+		if (spare == NULL) return -1;
+	}
+	
+	if (slist_sorted_gallop(list1, list2->count)) {
+		nodes1 = list1->prefetch->nodes; /* stale: the links below leave it as it is */
+		list1->prefetch->stale = true;
+	}
+	n1 = list1->count;
+	
+	/* prev1->next is always a node list1 had before the call, or NULL */
+	prev1 = list1->head;
+	prev2 = list2->head;
+	while ((x = prev2->next) != NULL) {
+		if (spare) {
+			copy = spare;
+			spare = copy->next;
+		}
+		if (nodes1) {
+			i = slist_sorted_seek(list1->data_cmp, nodes1, i, n1, x->data);
+			if (i != last_i) prev1 = nodes1[i - 1];
+			last_i = i;
+			next1 = i < n1 ? nodes1[i] : NULL;
+			visited++;
+		} else {
+			while (prev1->next && list1->data_cmp(prev1->next->data, x->data) < 0) {
+				prev1 = prev1->next;
+				visited++;
+			}
+			next1 = prev1->next;
+		}
+		
+		if (next1 && list1->data_cmp(next1->data, x->data) == 0) { /* stays in list2 */
+			if (copy) slist_node_release(list1, copy);
+			prev2 = x;
+			continue;
+		}
+		
+		prev2->next = x->next;
+		if (copy) { /* the copy moves, x goes back to list2's allocator */
+			slist_node_release(list2, x);
+			x = copy;
+		}
+		x->next = prev1->next;
+		prev1->next = x;
+		prev1 = x;
+		moved++;
+		
+		if (x->next == NULL) /* maintain tail pointer */
+			list1->tail = x;
+	}
+	SLIST_STAT_WALK(list1, visited + list2->count);
+	
+	if (moved == 0) {
+		if (nodes1) list1->prefetch->stale = false; /* nothing was linked */
+		return 0;
+	}
+	
+	list1->count += moved;
+	SLIST_STAT_LENGTH(list1);
+	list2->count -= moved;
+	list2->tail = (prev2 == list2->head) ? NULL : prev2;
+	
+	assert(list1->tail->next == NULL);
+	assert(list2->tail == NULL || list2->tail->next == NULL);
+	
+	slist_relinked(list1);
+	slist_relinked(list2);
+	
+	return (long)moved;
+}
+
+long slist_sorted_intersect(Slist *list1, Slist *list2)
+{
+	return slist_sorted_filter(list1, list2, true);
+}
+
+long slist_sorted_difference(Slist *list1, Slist *list2)
+{
+	return slist_sorted_filter(list1, list2, false);
+}
+
+/* one pass over list1 removing the nodes whose data are in list2 (common ==
+   false) or are not (common == true), list2 is only read */
+static long slist_sorted_filter(Slist *list1, Slist *list2, bool common)
+{
+	size_t removed = 0, visited = 0, rank = 0, j = 0, n2 = 0;
+	SlistNode **nodes2 = NULL, *p = NULL, *q = NULL, *free_node = NULL;
+	bool found = false, failed = false;
+	
+	assert(list1 != NULL);
+	assert(list1->head != NULL);
+	assert(list2 != NULL);
+	assert(list2->head != NULL);
+	assert(list1 != list2);
+	assert(list1->sorted && list2->sorted);
+	
+	SLIST_STAT_CALL(list1, SLIST_OP_SET);
+	
+	if (list1->map != NULL) return -1;
+	if (list2->map != NULL && !slist_map_nodes(list2)) return -1;
+	/* list2 is walked while list1 frees nodes, it must not be reading them */
+	if (list2->source == list1 && slist_unshare(list2) != 0) return -1;
+	
+	if (slist_sorted_gallop(list2, list1->count)) 
+		nodes2 = list2->prefetch->nodes;
+	n2 = list2->count;
+	q = list2->head->next;
+	
+	p = list1->head;
+	while (p->next) {
+		if (nodes2) {
+			j = slist_sorted_seek(list1->data_cmp, nodes2, j, n2, p->next->data);
+			q = j < n2 ? nodes2[j] : NULL;
+		} else {
+			while (q && list1->data_cmp(q->data, p->next->data) < 0) {
+				q = q->next;
+				visited++;
+			}
+		}
+		if (q == NULL && !common) break; /* the rest of list1 stays */
+		
+		found = q && list1->data_cmp(q->data, p->next->data) == 0;
+		if (found != common) {
+			p = slist_share_own(list1, p, rank, rank + 1);
+			if (p == NULL) { /* the nodes removed so far stay removed */
+				failed = true;
+				break;
+			}
+			
+			free_node = slist_unlink_after(list1, p, rank);
+			
+			if (list1->data_free) list1->data_free(free_node->data); 
+			slist_node_release(list1, free_node);
+			
+			removed++;
+			continue;
+		}
+		p = p->next;
+		rank++;
+	}
+	SLIST_STAT_WALK(list1, rank + removed + visited);
+	
+	return failed ? -1 : (long)removed;
+}
+
+// cursor --- O(1) each, O(logn) with index
+void slist_cursor_init(SlistCursor *cursor, Slist *list)
+{
+	assert(cursor != NULL);
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	if (list->map != NULL) /* out of memory leaves the cursor at the end */
+		slist_map_nodes(list);
+	
+	cursor->list = list;
+	cursor->prev = list->head;
+	cursor->rank = 0;
+	
+	return;
+}
+
+bool slist_cursor_next(SlistCursor *cursor)
+{
+	assert(cursor != NULL);
+	assert(cursor->prev != NULL);
+	
+	if (cursor->prev->next == NULL) return false;
+	
+	cursor->prev = cursor->prev->next;
+	cursor->rank++;
+	
+	return cursor->prev->next != NULL;
+}
+
+SlistNode *slist_cursor_node(SlistCursor *cursor)
+{
+	SlistNode *prev = NULL;
+	
+	assert(cursor != NULL);
+	assert(cursor->prev != NULL);
+	
+	if (cursor->prev->next != NULL && cursor->list->source != NULL) { /* hand out the list's own node */
+		prev = slist_share_own(cursor->list, cursor->prev, cursor->rank, cursor->rank + 1);
+		if (prev == NULL) return NULL;
+		cursor->prev = prev;
+	}
+	
+	return cursor->prev->next;
+}
+
+void *slist_cursor_peek(SlistCursor *cursor)
+{
+	assert(cursor != NULL);
+	assert(cursor->prev != NULL);
+	
+	if (cursor->prev->next == NULL) return NULL;
+	
+	return cursor->prev->next->data;
+}
+
+int slist_cursor_insert_before(SlistCursor *cursor, void *data)
+{
+	SlistNode *new_node = NULL, *prev = NULL;
+	
+	assert(cursor != NULL);
+	assert(cursor->prev != NULL);
+	
+	SLIST_STAT_CALL(cursor->list, SLIST_OP_CURSOR);
+	
+	if (cursor->list->map != NULL) return -1;
+	
+	prev = slist_share_own(cursor->list, cursor->prev, cursor->rank, cursor->rank);
+	if (prev == NULL) return -1;
+	cursor->prev = prev;
+	
+	new_node = slist_node_create(cursor->list, data);
+	if (new_node == NULL) return -1;
+	
+	assert(new_node != NULL);
+	
+	slist_link_after(cursor->list, cursor->prev, cursor->rank, new_node);
+	
+	cursor->prev = new_node;
+	cursor->rank++;
+	
+	return 0;
+}
+
+int slist_cursor_insert_after(SlistCursor *cursor, void *data)
+{
+	SlistNode *new_node = NULL, *prev = NULL;
+	
+	assert(cursor != NULL);
+	assert(cursor->prev != NULL);
+	
+	SLIST_STAT_CALL(cursor->list, SLIST_OP_CURSOR);
+	
+	if (cursor->list->map != NULL) return -1;
+	if (cursor->prev->next == NULL) return -1;
+	
+	prev = slist_share_own(cursor->list, cursor->prev, cursor->rank, cursor->rank + 1);
+	if (prev == NULL) return -2;
+	cursor->prev = prev;
+	
+	new_node = slist_node_create(cursor->list, data);
+	if (new_node == NULL) return -2;
+	
+	assert(new_node != NULL);
+	
+	slist_link_after(cursor->list, cursor->prev->next, cursor->rank + 1, new_node);
+	
+	return 0;
+}
+
+void *slist_cursor_remove(SlistCursor *cursor)
+{
+	void *ret_data = NULL;
+	SlistNode *free_node = NULL, *prev = NULL;
+	
+	assert(cursor != NULL);
+	assert(cursor->prev != NULL);
+	
+	SLIST_STAT_CALL(cursor->list, SLIST_OP_CURSOR);
+	
+	if (cursor->list->map != NULL) return NULL;
+	if (cursor->prev->next == NULL) return NULL;
+	if (!slist_scratch_reserve(cursor->list, 1)) return NULL;
+	
+	prev = slist_share_own(cursor->list, cursor->prev, cursor->rank, cursor->rank + 1);
+	if (prev == NULL) return NULL;
+	cursor->prev = prev;
+	
+	free_node = slist_unlink_after(cursor->list, cursor->prev, cursor->rank);
+	
+	ret_data = slist_node_take_data(cursor->list, free_node, 0);
+	slist_node_release(cursor->list, free_node);
+	
+	return ret_data;
+}
+
+int slist_cursor_remove_deep(SlistCursor *cursor)
+{
+	void *data = NULL;
+	
+	assert(cursor != NULL);
+	assert(cursor->prev != NULL);
+	
+	if (cursor->list->map != NULL) return -1;
+	if (cursor->prev->next == NULL) return -1;
+	
+	data = slist_cursor_remove(cursor);
+	if (cursor->list->data_free) cursor->list->data_free(data);
+	
+	return 0;
+}
+
+// index --- optional skip list, positional access O(logn)
+int slist_index_enable(Slist *list)
+{
+	struct SlistIndex *index = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	if (list->map != NULL) return -1;
+	if (list->index != NULL) return 0;
+	if (slist_unshare(list) != 0) return -1; /* towers point at nodes */
+	
+	index = (struct SlistIndex *)malloc(sizeof(struct SlistIndex));
+	if (index == NULL) return -1;
+	
+	index->header = (struct SlistIndexTower *)malloc(sizeof(struct SlistIndexTower) + 
+	                         SLIST_INDEX_MAXLEVEL * sizeof(struct SlistIndexLink));
+	if (index->header == NULL) {
+		free(index);
+		return -1;
+	}
+	
+	index->header->node = list->head;
+	index->level = 0;
+	index->stale = true; /* built on the first positional access */
+	index->seed = 2463534242u;
+	
+	slist_index_towers_free(index);
+	
+	list->index = index;
+	
+	return 0;
+}
+
+void slist_index_disable(Slist *list)
+{
+	assert(list != NULL);
+	
+	if (list->index == NULL) return;
+	
+	slist_index_towers_free(list->index);
+	free(list->index->header);
+	free(list->index);
+	list->index = NULL;
+	
+	return;
+}
+
+static void slist_index_towers_free(struct SlistIndex *index)
+{
+	struct SlistIndexTower *tower = NULL, *next = NULL;
+	int k = 0;
+	
+	assert(index != NULL);
+	
+	/* every tower is at least level 1, level 0 chains them all */
+	tower = index->level > 0 ? index->header->link[0].next : NULL;
+	while (tower) {
+		next = tower->link[0].next;
+		free(tower);
+		tower = next;
+	}
+	
+	for (k = 0; k < SLIST_INDEX_MAXLEVEL; k++) {
+		index->header->link[k].next = NULL;
+		index->header->link[k].span = 0;
+		index->last[k] = index->header;
+		index->last_rank[k] = 0;
+	}
+	index->level = 0;
+	
+	return;
+}
+
+/* xorshift, every further level with probability 1/4 */
+static int slist_index_random_level(struct SlistIndex *index)
+{
+	int level = 0;
+	
+	assert(index != NULL);
+	
+	index->seed ^= index->seed << 13;
+	index->seed ^= index->seed >> 17;
+	index->seed ^= index->seed << 5;
+	
+	while (level < SLIST_INDEX_MAXLEVEL / 2 && ((index->seed >> (2 * level)) & 3) == 0)
+		level++;
+	
+	return level;
+}
+
+/* a live index or hash needs every node to go through link/unlink */
+static bool slist_has_side_index(Slist *list)
+{
+	assert(list != NULL);
+	
+	return (list->index != NULL && !list->index->stale) ||
+	       (list->hash != NULL && !list->hash->stale);
+}
+
+/* nodes were relinked wholesale, side structures are rebuilt lazily */
+static void slist_relinked(Slist *list)
+{
+	assert(list != NULL);
+	assert(list->map == NULL);
+	
+	slist_index_invalidate(list);
+	
+	if (list->hash != NULL) 
+		list->hash->stale = true;
+	
+	if (list->prefetch != NULL) 
+		list->prefetch->stale = true;
+	
+	if (list->compact != NULL) 
+		list->compact->stale = true;
+	
+	return;
+}
+
+/* O(1), for changes whose position is unknown or that move many nodes */
+static void slist_index_invalidate(Slist *list)
+{
+	assert(list != NULL);
+	
+	if (list->index != NULL) 
+		list->index->stale = true;
+	
+	return;
+}
+
+/* rebuild a stale index in one pass, false leaves positional access to the plain walk */
+static bool slist_index_ready(Slist *list)
+{
+	struct SlistIndex *index = list->index;
+	struct SlistIndexTower *tower = NULL;
+	SlistNode *p = NULL;
+	size_t rank = 0;
+	int k = 0, level = 0;
+	
+	assert(list != NULL);
+	
+	if (index == NULL) return false;
+	if (!index->stale) return true;
+	
+	slist_index_towers_free(index);
+	
+	for (p = list->head->next; p; p = p->next) {
+		rank++;
+		
+		level = slist_index_random_level(index);
+		if (level == 0) continue;
+		
+		tower = (struct SlistIndexTower *)malloc(sizeof(struct SlistIndexTower) + 
+		                                         level * sizeof(struct SlistIndexLink));
+		if (tower == NULL) {
+			slist_index_towers_free(index);
+			return false;
+		}
+		
+		tower->node = p;
+		for (k = 0; k < level; k++) {
+			tower->link[k].next = NULL;
+			tower->link[k].span = 0;
+			index->last[k]->link[k].next = tower;
+			index->last[k]->link[k].span = rank - index->last_rank[k];
+			index->last[k] = tower;
+			index->last_rank[k] = rank;
+		}
+		if (level > index->level) index->level = level;
+	}
+	SLIST_STAT_WALK(list, rank);
+	
+	index->stale = false;
+	
+	return true;
+}
+
+/* node at rank, update[k] and update_rank[k] receive the last tower at or 
+   before rank on every level */
+static SlistNode *slist_index_seek(Slist *list, size_t rank, struct SlistIndexTower **update, size_t *update_rank)
+{
+	struct SlistIndexTower *tower = NULL;
+	SlistNode *p = NULL;
+	size_t traversed = 0, hops = 0;
+	int k = 0;
+	
+	assert(list != NULL);
+	assert(list->index != NULL);
+	assert(!list->index->stale);
+	
+	tower = list->index->header;
+	for (k = list->index->level - 1; k >= 0; k--) {
+		while (tower->link[k].next && traversed + tower->link[k].span <= rank) {
+			traversed += tower->link[k].span;
+			tower = tower->link[k].next;
+			hops++;
+		}
+		if (update) {
+			update[k] = tower;
+			update_rank[k] = traversed;
+		}
+	}
+	
+	SLIST_STAT_WALK(list, hops + (rank - traversed));
+	for (p = tower->node; traversed < rank; traversed++) p = p->next;
+	
+	return p;
+}
+
+// hash --- optional index on data_hash, lookups by data O(1)
+int slist_hash_enable(Slist *list, SlistDataHash *data_hash)
+{
+	struct SlistHash *hash = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(list->data_equ != NULL);
+	assert(data_hash != NULL);
+	
+	if (list->map != NULL) return -1;
+	if (list->hash != NULL) {
+		if (list->hash->data_hash != data_hash) { /* slots are placed by the old function */
+			list->hash->data_hash = data_hash;
+			list->hash->stale = true;
+		}
+		return 0;
+	}
+	if (slist_unshare(list) != 0) return -1;
+	
+	hash = (struct SlistHash *)malloc(sizeof(struct SlistHash));
+	if (hash == NULL) return -1;
+	
+	hash->data_hash = data_hash;
+	hash->slots = NULL;
+	hash->mask = 0;
+	hash->used = 0;
+	hash->stale = true; /* built on the first lookup */
+	
+	list->hash = hash;
+	
+	return 0;
+}
+
+void slist_hash_disable(Slist *list)
+{
+	assert(list != NULL);
+	
+	if (list->hash == NULL) return;
+	
+	free(list->hash->slots);
+	free(list->hash);
+	list->hash = NULL;
+	
+	return;
+}
+
+/* grow to keep the load under 3/4, entries are moved without calling data_hash */
+static bool slist_hash_reserve(struct SlistHash *hash, size_t count)
+{
+	struct SlistHashEntry *old_slots = NULL;
+	size_t old_size = 0, size = 16, i = 0, j = 0;
+	
+	assert(hash != NULL);
+	
+	if (hash->slots != NULL && count * 4 <= (hash->mask + 1) * 3) return true;
+	
+	while (count * 4 > size * 3) size *= 2;
+	
+	old_slots = hash->slots;
+	old_size = old_slots ? hash->mask + 1 : 0;
+	
+	hash->slots = (struct SlistHashEntry *)calloc(size, sizeof(struct SlistHashEntry));
+	if (hash->slots == NULL) {
+		hash->slots = old_slots;
+		return false;
+	}
+	hash->mask = size - 1;
+	
+	for (i = 0; i < old_size; i++) {
+		if (old_slots[i].prev == NULL) continue;
+		
+		for (j = old_slots[i].hash & hash->mask; hash->slots[j].prev; j = (j + 1) & hash->mask);
+		hash->slots[j] = old_slots[i];
+	}
+	free(old_slots);
+	
+	return true;
+}
+
+/* slot of the entry for prev->next, which must be in the table */
+static size_t slist_hash_slot(struct SlistHash *hash, SlistNode *prev, size_t h)
+{
+	size_t i = 0;
+	
+	assert(hash != NULL);
+	assert(prev != NULL);
+	
+	for (i = h & hash->mask; hash->slots[i].prev != prev; i = (i + 1) & hash->mask)
+		assert(hash->slots[i].prev != NULL);
+	
+	return i;
+}
+
+static void slist_hash_link(Slist *list, SlistNode *prev, SlistNode *node)
+{
+	struct SlistHash *hash = list->hash;
+	size_t h = 0, i = 0;
+	
+	assert(hash != NULL);
+	assert(prev->next == node);
+	
+	if (hash->stale) return;
+	if (!slist_hash_reserve(hash, hash->used + 1)) {
+		hash->stale = true;
+		return;
+	}
+	
+	if (node->next != NULL) { /* the successor's predecessor is now node */
+		i = slist_hash_slot(hash, prev, hash->data_hash(node->next->data));
+		hash->slots[i].prev = node;
+	}
+	
+	h = hash->data_hash(node->data);
+	for (i = h & hash->mask; hash->slots[i].prev; i = (i + 1) & hash->mask);
+	hash->slots[i].prev = prev;
+	hash->slots[i].hash = h;
+	hash->used++;
+	
+	return;
+}
+
+/* node is already unlinked from prev but still points to its old successor */
+static void slist_hash_unlink(Slist *list, SlistNode *prev, SlistNode *node)
+{
+	struct SlistHash *hash = list->hash;
+	size_t i = 0, j = 0, home = 0;
+	
+	assert(hash != NULL);
+	assert(prev->next == node->next);
+	
+	if (hash->stale) return;
+	
+	i = slist_hash_slot(hash, prev, hash->data_hash(node->data));
+	hash->slots[i].prev = NULL;
+	hash->used--;
+	
+	/* backward shift: pull later entries of the run into the hole */
+	for (j = (i + 1) & hash->mask; hash->slots[j].prev; j = (j + 1) & hash->mask) {
+		home = hash->slots[j].hash & hash->mask;
+		if (((j - home) & hash->mask) < ((j - i) & hash->mask)) continue;
+		
+		hash->slots[i] = hash->slots[j];
+		hash->slots[j].prev = NULL;
+		i = j;
+	}
+	
+	if (node->next != NULL) { /* the successor's predecessor is now prev */
+		i = slist_hash_slot(hash, node, hash->data_hash(node->next->data));
+		hash->slots[i].prev = prev;
+	}
+	
+	return;
+}
+
+/* predecessor of a node equal to data, NULL when there is none */
+static SlistNode *slist_hash_find_prev(Slist *list, void *data)
+{
+	struct SlistHash *hash = list->hash;
+	size_t h = 0, i = 0, probes = 0;
+	
+	assert(hash != NULL);
+	assert(!hash->stale);
+	
+	h = hash->data_hash(data);
+	for (i = h & hash->mask; hash->slots[i].prev; i = (i + 1) & hash->mask, probes++) {
+		if (hash->slots[i].hash == h && list->data_equ(hash->slots[i].prev->next->data, data)) {
+			SLIST_STAT_WALK(list, probes + 1);
+			return hash->slots[i].prev;
+		}
+	}
+	SLIST_STAT_WALK(list, probes);
+	
+	return NULL;
+}
+
+/* rebuild a stale table in one pass, false leaves lookups to the plain walk */
+static bool slist_hash_ready(Slist *list)
+{
+	struct SlistHash *hash = list->hash;
+	SlistNode *p = NULL;
+	size_t h = 0, i = 0;
+	
+	assert(list != NULL);
+	
+	if (hash == NULL) return false;
+	if (!hash->stale) return true;
+	
+	if (hash->slots != NULL) 
+		memset(hash->slots, 0, (hash->mask + 1) * sizeof(struct SlistHashEntry));
+	hash->used = 0;
+	
+	if (!slist_hash_reserve(hash, list->count)) return false;
+	
+	for (p = list->head; p->next; p = p->next) {
+		h = hash->data_hash(p->next->data);
+		for (i = h & hash->mask; hash->slots[i].prev; i = (i + 1) & hash->mask);
+		hash->slots[i].prev = p;
+		hash->slots[i].hash = h;
+	}
+	hash->used = list->count;
+	hash->stale = false;
+	SLIST_STAT_WALK(list, list->count);
+	
+	return true;
+}
+
+// prefetch --- optional jump table, scans request nodes ahead of use
+int slist_prefetch_enable(Slist *list, size_t distance)
+{
+	struct SlistPrefetch *prefetch = NULL;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	if (list->map != NULL) return -1;
+	if (distance == 0) distance = SLIST_PREFETCH_DISTANCE;
+	
+	if (list->prefetch != NULL) {
+		list->prefetch->distance = distance;
+		return 0;
+	}
+	if (slist_unshare(list) != 0) return -1;
+	
+	prefetch = (struct SlistPrefetch *)malloc(sizeof(struct SlistPrefetch));
+	if (prefetch == NULL) return -1;
+	
+	prefetch->nodes = NULL;
+	prefetch->size = 0;
+	prefetch->distance = distance;
+	prefetch->stale = true; /* built on the first scan */
+	
+	list->prefetch = prefetch;
+	
+	return 0;
+}
+
+void slist_prefetch_disable(Slist *list)
+{
+	assert(list != NULL);
+	
+	if (list->prefetch == NULL) return;
+	
+	free(list->prefetch->nodes);
+	free(list->prefetch);
+	list->prefetch = NULL;
+	
+	return;
+}
+
+/* grow by doubling, false leaves the table as it was */
+static bool slist_prefetch_reserve(struct SlistPrefetch *prefetch, size_t count)
+{
+	SlistNode **nodes = NULL;
+	size_t size = 0;
+	
+	assert(prefetch != NULL);
+	
+	if (count <= prefetch->size) return true;
+	
+	for (size = prefetch->size ? prefetch->size : 64; size < count; size *= 2);
+	
+	nodes = (SlistNode **)realloc(prefetch->nodes, size * sizeof(SlistNode *));
+	if (nodes == NULL) return false;
+	
+	prefetch->nodes = nodes;
+	prefetch->size = size;
+	
+	return true;
+}
+
+/* node is already linked and counted, only appends keep the table */
+static void slist_prefetch_link(Slist *list, SlistNode *node)
+{
+	struct SlistPrefetch *prefetch = list->prefetch;
+	
+	assert(prefetch != NULL);
+	
+	if (prefetch->stale) return;
+	if (node->next != NULL || !slist_prefetch_reserve(prefetch, list->count)) {
+		prefetch->stale = true;
+		return;
+	}
+	
+	prefetch->nodes[list->count - 1] = node;
+	
+	return;
+}
+
+/* nodes[i] was just unlinked, which marked the table stale. close the gap */
+static void slist_prefetch_erase(Slist *list, size_t i)
+{
+	struct SlistPrefetch *prefetch = list->prefetch;
+	
+	assert(prefetch != NULL);
+	assert(i <= list->count);
+	
+	memmove(prefetch->nodes + i, prefetch->nodes + i + 1, (list->count - i) * sizeof(SlistNode *));
+	prefetch->stale = false;
+	
+	return;
+}
+
+/* at step i request the node 2 * distance ahead and the data of the node 
+   distance ahead, whose node was requested distance steps earlier */
+static void slist_prefetch_ahead(struct SlistPrefetch *prefetch, size_t i, size_t n)
+{
+	size_t d = prefetch->distance;
+	
+	if (i + 2 * d < n) 
+		SLIST_PREFETCH(prefetch->nodes[i + 2 * d]);
+	if (i + d < n) 
+		SLIST_PREFETCH(prefetch->nodes[i + d]->data);
+	
+	return;
+}
+
+/* rebuild a stale table in one walk, false leaves scans to the plain walk */
+static bool slist_prefetch_ready(Slist *list)
+{
+	struct SlistPrefetch *prefetch = list->prefetch;
+	SlistNode *p = NULL;
+	size_t i = 0;
+	
+	assert(list != NULL);
+	
+	if (prefetch == NULL) return false;
+	if (!prefetch->stale) return true;
+	
+	if (!slist_prefetch_reserve(prefetch, list->count)) return false;
+	
+	for (p = list->head->next; p; p = p->next) 
+		prefetch->nodes[i++] = p;
+	
+	assert(i == list->count);
+	SLIST_STAT_WALK(list, i);
+	
+	prefetch->stale = false;
+	
+	return true;
+}
+
+// compact --- relocate the nodes of a pooled list into one block, in list order
+long slist_compact(Slist *list, size_t max_nodes)
+{
+	struct SlistCompact *compact = NULL;
+	struct SlistNodeSlab *slab = NULL;
+	SlistNode *slot = NULL;
+	size_t moved = 0;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_COMPACT);
+	
+	if (list->map != NULL) return -1;
+	/* malloc nodes go back one by one, intrusive nodes belong to the caller */
+	if (list->pool == NULL || list->intrusive) return -1;
+	if (slist_unshare(list) != 0) return -1; /* group nodes never move */
+	
+	if (max_nodes == 0) max_nodes = (size_t)-1;
+	
+	compact = list->compact;
+	if (compact == NULL) {
+		if (list->count == 0) return 0;
+		
+		compact = (struct SlistCompact *)malloc(sizeof(struct SlistCompact));
+		if (compact == NULL) return -1;
+		
+		compact->block = NULL;
+		compact->size = 0;
+		compact->used = 0;
+		compact->stale = true;
+		list->compact = compact;
+	}
+	
+	if (compact->stale) { /* start over, slots already handed out stay used */
+		compact->prev = list->head;
+		compact->rank = 0;
+		compact->stale = false;
+	}
+	
+	for (; compact->prev->next != NULL && moved < max_nodes; moved++) {
+		if (compact->used == compact->size) { /* the list grew, or a restart used up the block */
+			slist_compact_end_block(list);
+			slab = slist_node_pool_grow(list->pool, list->count - compact->rank);
+			if (slab == NULL) return -1;
+			
+			slab->used = slab->size; /* reserved, slots left over go to the free list */
+			SLIST_STAT_ALLOC(list, slab->size);
+			compact->block = slab->base;
+			compact->size = slab->size;
+			compact->used = 0;
+		}
+		
+		slot = (SlistNode *)(compact->block + compact->used++ * list->pool->node_size);
+		slist_node_move(list, compact->prev, compact->rank, slot);
+		
+		compact->prev = slot;
+		compact->rank++;
+	}
+	
+	SLIST_STAT_WALK(list, moved);
+	if (compact->prev->next != NULL) return (long)(list->count - compact->rank);
+	
+	slist_compact_end(list);
+	
+	return 0;
+}
+
+/* give the unused slots of the current block to the pool */
+static void slist_compact_end_block(Slist *list)
+{
+	struct SlistCompact *compact = list->compact;
+	
+	assert(compact != NULL);
+	
+	for (; compact->used < compact->size; compact->used++) 
+		slist_node_release(list, (SlistNode *)(compact->block + compact->used * list->pool->node_size));
+	
+	return;
+}
+
+static void slist_compact_end(Slist *list)
+{
+	assert(list != NULL);
+	
+	if (list->compact == NULL) return;
+	
+	slist_compact_end_block(list);
+	free(list->compact);
+	list->compact = NULL;
+	
+	return;
+}
+
+/* node was linked after the node at rank */
+static void slist_compact_link(Slist *list, size_t rank)
+{
+	struct SlistCompact *compact = list->compact;
+	
+	if (compact->stale) return;
+	
+	if (rank == SLIST_RANK_UNKNOWN) 
+		compact->stale = true;
+	else if (rank < compact->rank) /* lands in the done part, left where it is */
+		compact->rank++;
+	
+	return;
+}
+
+/* node was unlinked from behind prev, at rank */
+static void slist_compact_unlink(Slist *list, SlistNode *prev, size_t rank, SlistNode *node)
+{
+	struct SlistCompact *compact = list->compact;
+	
+	if (compact->stale) return;
+	
+	if (rank == SLIST_RANK_UNKNOWN) {
+		compact->stale = true;
+	} else if (rank < compact->rank) {
+		compact->rank--;
+		if (compact->prev == node) compact->prev = prev;
+	}
+	
+	return;
+}
+
+/* relocate prev->next, which is at rank + 1, to slot. the side structures 
+   follow, so a relayout in small steps never forces a rebuild */
+static void slist_node_move(Slist *list, SlistNode *prev, size_t rank, SlistNode *slot)
+{
+	struct SlistIndexTower *update[SLIST_INDEX_MAXLEVEL];
+	size_t update_rank[SLIST_INDEX_MAXLEVEL];
+	SlistNode *node = prev->next;
+	size_t i = 0;
+	
+	assert(node != NULL);
+	assert(slot != NULL);
+	
+	memcpy(slot, node, sizeof(SlistNode) + list->data_size);
+	if (list->data_size) slot->data = SLIST_NODE_PAYLOAD(slot);
+	
+	prev->next = slot;
+	if (list->tail == node) list->tail = slot;
+	
+	if (list->hash != NULL && !list->hash->stale && slot->next != NULL) {
+		/* the successor's entry is keyed by its predecessor */
+		i = slist_hash_slot(list->hash, node, list->hash->data_hash(slot->next->data));
+		list->hash->slots[i].prev = slot;
+	}
+	
+	if (list->index != NULL && !list->index->stale && list->index->level > 0) {
+		slist_index_seek(list, rank + 1, update, update_rank);
+		if (update[0]->node == node) update[0]->node = slot;
+	}
+	
+	if (list->prefetch != NULL && !list->prefetch->stale) 
+		list->prefetch->nodes[rank] = slot;
+	
+	slist_node_release(list, node);
+	
+	return;
+}
+
+// snapshot --- data by value in a flat file, mapped back without copying
+int slist_snapshot_write(Slist *list, const char *path, size_t data_size)
+{
+	struct SlistSnapshotHeader header;
+	unsigned char *buf = NULL;
+	SlistNode *p = NULL;
+	size_t used = 0, stride = 0, size = 0, i = 0;
+	int fd = -1, ret = 0;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	assert(path != NULL);
+	
+	if (data_size == 0) data_size = list->data_size;
+	assert(data_size > 0);
+	assert(list->data_size == 0 || list->data_size == data_size);
+	
+	stride = (data_size + 7) / 8 * 8;
+	if (stride > SLIST_SNAPSHOT_BUFFER) return -1;
+	
+	size = SLIST_SNAPSHOT_BUFFER;
+	if (list->count < (size - SLIST_SNAPSHOT_HEADER) / stride) 
+		size = SLIST_SNAPSHOT_HEADER + list->count * stride;
+	
+	buf = (unsigned char *)malloc(size);
+	if (buf == NULL) return -1;
+	
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		free(buf);
+		return -1;
+	}
+	
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SLIST_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = SLIST_SNAPSHOT_VERSION;
+	header.byte_order = 0x01020304;
+	header.count = list->count;
+	header.data_size = data_size;
+	header.stride = stride;
+	header.offset = SLIST_SNAPSHOT_HEADER;
+	
+	memset(buf, 0, SLIST_SNAPSHOT_HEADER);
+	memcpy(buf, &header, sizeof(header));
+	used = SLIST_SNAPSHOT_HEADER;
+	
+	p = list->head->next;
+	for (i = 0; i < list->count && ret == 0; i++) {
+		if (used + stride > size) 
+			ret = slist_snapshot_flush(fd, buf, &used);
+		
+		memset(buf + used + data_size, 0, stride - data_size);
+		if (list->map != NULL) {
+			memcpy(buf + used, list->map->records + i * list->map->stride, data_size);
+		} else {
+			memcpy(buf + used, p->data, data_size);
+			p = p->next;
+		}
+		used += stride;
+	}
+	if (ret == 0) ret = slist_snapshot_flush(fd, buf, &used);
+	
+	if (close(fd) != 0) ret = -1;
+	free(buf);
+	
+	return ret;
+}
+
+static int slist_snapshot_flush(int fd, unsigned char *buf, size_t *used)
+{
+	size_t done = 0;
+	ssize_t n = 0;
+	
+	while (done < *used) {
+		n = write(fd, buf + done, *used - done);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return -1;
+		done += (size_t)n;
+	}
+	
+	*used = 0;
+	
+	return 0;
+}
+
+Slist *slist_snapshot_map(const char *path, SlistDataCmp *data_cmp, SlistDataEqu *data_equ)
+{
+	struct SlistSnapshotHeader header;
+	struct stat st;
+	Slist *list = NULL;
+	struct SlistMap *map = NULL;
+	void *addr = NULL;
+	int fd = -1;
+	
+	assert(path != NULL);
+	
+	fd = open(path, O_RDONLY);
+	if (fd < 0) return NULL;
+	
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < SLIST_SNAPSHOT_HEADER) {
+		close(fd);
+		return NULL;
+	}
+	
+	addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); /* the mapping keeps the file */
+	if (addr == MAP_FAILED) return NULL;
+	
+	memcpy(&header, addr, sizeof(header));
+	if (memcmp(header.magic, SLIST_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+	    header.version != SLIST_SNAPSHOT_VERSION ||
+	    header.byte_order != 0x01020304 ||
+	    header.data_size == 0 || header.stride < header.data_size || header.stride % 8 != 0 ||
+	    header.offset < sizeof(header) || header.offset % 8 != 0 || header.offset > (uint64_t)st.st_size ||
+	    header.count > ((uint64_t)st.st_size - header.offset) / header.stride) {
+		munmap(addr, (size_t)st.st_size);
+		return NULL;
+	}
+	
+	map = (struct SlistMap *)malloc(sizeof(struct SlistMap));
+	list = slist_create_pool(data_cmp, data_equ, NULL, NULL, NULL);
+	if (map == NULL || list == NULL) {
+		free(map);
+		if (list) slist_destroy(list);
+		munmap(addr, (size_t)st.st_size);
+		return NULL;
+	}
+	
+	map->addr = addr;
+	map->length = (size_t)st.st_size;
+	map->records = (unsigned char *)addr + header.offset;
+	map->stride = (size_t)header.stride;
+	map->nodes = NULL;
+	
+	list->map = map;
+	list->count = (size_t)header.count;
+	list->data_size = (size_t)header.data_size;
+	SLIST_STAT_LENGTH(list);
+	
+	return list;
+}
+
+/* copies of a mapped list are ordinary inline lists */
+static Slist *slist_map_copy(Slist *list)
+{
+	Slist *new_list = NULL;
+	SlistNode *new_node = NULL;
+	size_t i = 0;
+	
+	assert(list->map != NULL);
+	
+	new_list = slist_create_inline(list->data_size, list->data_cmp, list->data_equ, NULL);
+	if (new_list == NULL) return NULL;
+	
+	for (i = 0; i < list->count; i++) {
+		new_node = slist_node_create(new_list, list->map->records + i * list->map->stride);
+		if (new_node == NULL) {
+			slist_clear(new_list);
+			slist_destroy(new_list);
+			return NULL;
+		}
+		
+		slist_add_node_last_internal(new_list, new_node);
+	}
+	
+	return new_list;
+}
+
+/* nodes over the records, one table for the whole list, so node functions
+   and walks along next work on a mapped list. false when out of memory */
+static bool slist_map_nodes(Slist *list)
+{
+	struct SlistMap *map = list->map;
+	size_t i = 0;
+	
+	assert(map != NULL);
+	
+	if (map->nodes != NULL || list->count == 0) return true;
+	
+	map->nodes = (SlistNode *)malloc(list->count * sizeof(SlistNode));
+	if (map->nodes == NULL) return false;
+	
+	for (i = 0; i < list->count; i++) {
+		map->nodes[i].data = map->records + i * map->stride;
+		map->nodes[i].next = (i + 1 < list->count) ? &map->nodes[i + 1] : NULL;
+	}
+	
+	list->head->next = map->nodes;
+	list->tail = &map->nodes[list->count - 1];
+	
+	return true;
+}
+
+// share --- lazy copies, see slist_copy_lazy
+Slist *slist_copy_lazy(Slist *list)
+{
+	Slist *new_list = NULL, *source = NULL;
+	SlistNode *p = NULL, *new_node = NULL;
+	size_t i = 0;
+	
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	if (!slist_share_able(list)) return slist_copy(list);
+	
+	SLIST_STAT_CALL(list, SLIST_OP_COPY);
+	
+	new_list = slist_create_pool(list->data_cmp, 
+	                             list->data_equ, 
+	                             list->data_copy, 
+	                             list->data_free,
+	                             list->pool);
+	if (new_list == NULL) return NULL;
+	
+	new_list->data_free_batch = list->data_free_batch;
+	new_list->sorted = list->sorted;
+	
+	if (list->count == 0) return new_list;
+	
+	/* a lazy copy's own prefix is copied, its shared nodes are read too */
+	source = list->source ? list->source : list;
+	p = list->head->next;
+	for (i = 0; list->source && i < list->share_rank; i++, p = p->next) {
+		new_node = slist_node_create(new_list, p->data);
+		if (new_node == NULL) { /* the data are still list's */
+			slist_clear(new_list);
+			slist_destroy(new_list);
+			return NULL;
+		}
+		slist_add_node_last_internal(new_list, new_node);
+	}
+	SLIST_STAT_WALK(list, i);
+	
+	new_list->share_prev = new_list->tail ? new_list->tail : new_list->head;
+	new_list->share_prev->next = p;
+	new_list->share_rank = i;
+	new_list->tail = list->tail;
+	new_list->count = list->count;
+	SLIST_STAT_LENGTH(new_list);
+	
+	slist_share_join(new_list, source);
+	
+	return new_list;
+}
+
+bool slist_isshared(Slist *list)
+{
+	assert(list != NULL);
+	
+	return list->source != NULL || list->views != NULL;
+}
+
+int slist_unshare(Slist *list)
+{
+	assert(list != NULL);
+	assert(list->head != NULL);
+	
+	return slist_share_own(list, list->head, 0, list->count) ? 0 : -1;
+}
+
+static bool slist_share_able(Slist *list)
+{
+	return list->map == NULL && !list->intrusive && list->index == NULL && 
+	       list->hash == NULL && list->prefetch == NULL && list->compact == NULL;
+}
+
+/* every edit comes here before it writes the nodes up to rank upto: a lazy
+   copy copies the shared ones into its own prefix, a source makes its copies
+   do so until they read nothing up to there. returns the node now at rank,
+   node itself when it already was the list's, NULL when out of memory with
+   the copies made so far kept */
+static SlistNode *slist_share_own(Slist *list, SlistNode *node, size_t rank, size_t upto)
+{
+	Slist *view = NULL, *next = NULL;
+	SlistNode *p = NULL, *copy = NULL;
+	size_t from = 0, keep = 0;
+	
+	assert(list != NULL);
+	assert(rank <= upto && upto <= list->count);
+	
+	keep = list->count - upto; /* nodes a copy may still read */
+	for (view = list->views; view; view = next) {
+		next = view->view_next; /* a copy done reading leaves the chain */
+		if (view->count - view->share_rank > keep && 
+		    slist_share_own(view, view->head, 0, view->count - keep) == NULL) return NULL;
+	}
+	
+	if (list->source == NULL || upto <= list->share_rank) return node;
+	
+	from = list->share_rank;
+	p = list->share_prev;
+	while (list->share_rank < upto) {
+		copy = slist_node_create(list, p->next->data); /* inline data are copied too */
+		if (copy == NULL) break;
+		
+		copy->next = p->next->next;
+		p->next = copy;
+		p = copy;
+		
+		list->share_prev = p;
+		list->share_rank++;
+		if (list->share_rank == rank) node = p;
+	}
+	SLIST_STAT_WALK(list, list->share_rank - from);
+	
+	if (list->share_rank < upto) return NULL;
+	
+	if (list->share_rank == list->count) { /* the list owns every node again */
+		list->tail = p;
+		slist_share_leave(list);
+	}
+	
+	return node;
+}
+
+/* slist_node_at_rank for an edit. past the own prefix the copying walk
+   reaches rank itself, the list is not walked twice */
+static SlistNode *slist_share_at_rank(Slist *list, size_t rank, size_t upto)
+{
+	if (list->source != NULL && rank > list->share_rank) 
+		return slist_share_own(list, NULL, rank, upto);
+	
+	return slist_share_own(list, slist_node_at_rank(list, rank), rank, upto);
+}
+
+/* the anchor of an O(1) edit is looked up in a shared list to learn its rank.
+   NULL for a node not in the list or out of memory */
+static SlistNode *slist_share_find(Slist *list, SlistNode *node)
+{
+	SlistNode *p = NULL;
+	size_t rank = 0;
+	
+	if (!slist_isshared(list)) return node;
+	
+	for (p = list->head->next, rank = 1; p && p != node; p = p->next, rank++);
+	SLIST_STAT_WALK(list, p ? rank : list->count);
+	if (p == NULL || !slist_share_mine(list, rank)) return NULL;
+	
+	return slist_share_own(list, node, rank, rank);
+}
+
+/* a node found at rank is the list's own, not one a lazy copy reads */
+static bool slist_share_mine(Slist *list, size_t rank)
+{
+	return list->source == NULL || rank <= list->share_rank;
+}
+
+/* list becomes a lazy copy of source */
+static void slist_share_join(Slist *list, Slist *source)
+{
+	list->source = source;
+	list->view_prev = NULL;
+	list->view_next = source->views;
+	if (source->views) source->views->view_prev = list;
+	source->views = list;
+	
+	return;
+}
+
+/* the nodes from's lazy copies read are the last ones of list now */
+static void slist_share_adopt(Slist *list, Slist *from)
+{
+	Slist *view = NULL, *next = NULL;
+	
+	for (view = from->views; view; view = next) {
+		next = view->view_next;
+		slist_share_join(view, list);
+	}
+	from->views = NULL;
+	
+	return;
+}
+
+/* before the list frees its nodes: a lazy copy drops the shared ones, a
+   source gives the nodes its copies read to the copy reading most of them,
+   the other copies read that one's from then on */
+static void slist_share_detach(Slist *list)
+{
+	Slist *view = NULL, *heir = NULL;
+	SlistNode *p = NULL;
+	size_t given = 0;
+	
+	if (list->source != NULL) {
+		list->share_prev->next = NULL;
+		list->tail = (list->share_prev == list->head) ? NULL : list->share_prev;
+		list->count = list->share_rank;
+		
+		slist_share_leave(list);
+		return;
+	}
+	if (list->views == NULL) return;
+	
+	for (view = list->views; view; view = view->view_next) {
+		if (heir == NULL || view->count - view->share_rank > given) {
+			heir = view;
+			given = view->count - view->share_rank;
+		}
+	}
+	
+	p = slist_node_at_rank(list, list->count - given);
+	p->next = NULL;
+	list->tail = (p == list->head) ? NULL : p;
+	list->count -= given;
+	
+	slist_share_leave(heir);
+	slist_share_adopt(heir, list);
+	
+	return;
+}
+
+/* a lazy copy that reads no shared node any more leaves its source */
+static void slist_share_leave(Slist *list)
+{
+	assert(list->source != NULL);
+	
+	if (list->view_prev) list->view_prev->view_next = list->view_next;
+	else list->source->views = list->view_next;
+	if (list->view_next) list->view_next->view_prev = list->view_prev;
+	
+	list->source = NULL;
+	list->share_prev = list->head;
+	list->share_rank = 0;
+	list->view_prev = NULL;
+	list->view_next = NULL;
+	
+	return;
+}
+
+// stats --- counters of one list, -DSLIST_STATS
+int slist_get_stats(Slist *list, SlistStats *stats)
+{
+	assert(list != NULL);
+	assert(stats != NULL);
+	
+#ifdef SLIST_STATS
+	*stats = list->stats;
+	
+	return 0;
+#else
+	memset(stats, 0, sizeof(SlistStats));
+	
+	return -1;
+#endif
+}
+
+void slist_reset_stats(Slist *list)
+{
+	assert(list != NULL);
+	
+#ifdef SLIST_STATS
+	memset(&list->stats, 0, sizeof(list->stats));
+	list->stats.max_count = list->count;
+#endif
+	
+	return;
+}
+
+#ifdef SLIST_STATS
+/* one walk of nodes charged to op, bucket k holds lengths below 2^k */
+static void slist_stats_walk(Slist *list, SlistOp op, size_t nodes)
+{
+	int k = 0;
+	
+	list->stats.visited[op] += nodes;
+	
+	for (k = 0; nodes > 0 && k < SLIST_STATS_BUCKETS - 1; k++) nodes >>= 1;
+	list->stats.walks[k]++;
+	
+	return;
+}
+#endif
@@ -6,18 +6,53 @@
 
 typedef struct SlistNode SlistNode;
 typedef struct Slist Slist;
+typedef struct SlistNodePool SlistNodePool;
+
+//public so that intrusive lists can embed it in the caller's struct.
+struct SlistNode {
+	struct SlistNode *next;
+	void *data;
+};
+
+//container of an embedded node: slist_entry(node, struct msg, link)
+#define slist_entry(node, type, member) \
+	((type *)((char *)(node) - offsetof(type, member)))
 
 typedef int   SlistDataCmp (void *data1, void *data2);
 typedef bool  SlistDataEqu (void *data1, void *data2);
 typedef void* SlistDataCopy(void *data);
 typedef void  SlistDataFree(void *data);
+typedef void  SlistDataFreeBatch(void **data, size_t n);
 
 typedef int SlistDataFind(void *data,void *user_data);
 
+typedef size_t SlistDataHash(void *data);  /* equal data must hash equal */
+
+//cursor remembers the predecessor of the current node, so edits at the cursor
+//are O(1). only edits made through the cursor keep it valid.
+typedef struct SlistCursor {
+	Slist *list;
+	SlistNode *prev;   /* current node is prev->next, NULL at the end */
+	size_t rank;       /* position of prev, 0 for the head */
+} SlistCursor;
+
 
 // Slist new
 Slist *slist_create(void);
 Slist *slist_create_full(SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistDataCopy *data_copy, SlistDataFree *data_free);
+//pool may be shared by several lists and must outlive all of them.
+Slist *slist_create_pool(SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistDataCopy *data_copy, SlistDataFree *data_free, SlistNodePool *pool);
+//intrusive: nodes live in the caller's structs, only add_node_* insert, removing
+//never frees a node, data_free (may be NULL) gets the node's data.
+Slist *slist_create_intrusive(SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistDataFree *data_free);
+//inline: data_size bytes are copied into each node behind the next pointer,
+//add_data_* copy from the pointer given, get_* point into the node. removed
+//data are handed out from a buffer valid until the next removal. pool is
+//NULL or made by slist_node_pool_create_inline with the same data_size.
+//NULL gives the list a pool of its own, so splice, concat, sort_merge and
+//union with another inline list copy the nodes, O(m). Lists created on one
+//shared pool keep them O(1).
+Slist *slist_create_inline(size_t data_size, SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistNodePool *pool);
 
 // Slist free
 void slist_destroy(Slist *list);  
@@ -27,9 +62,14 @@ void slist_destroy_deep(Slist *list);
 Slist *slist_copy(Slist *list);  
 Slist *slist_copy_deep(Slist *list);
 
-// Slist clear
+// Slist clear --- nodes of a pooled or intrusive list go back in O(1), a
+// malloc list frees them one by one. clear_deep hands every data to data_free,
+// or in arrays of up to 256 to data_free_batch when one is set.
 void slist_clear(Slist *list);
 void slist_clear_deep(Slist *list);
+//used instead of data_free by clear_deep and destroy_deep, NULL turns it off.
+//copies and splits inherit it.
+void slist_set_data_free_batch(Slist *list, SlistDataFreeBatch *data_free_batch);
 
 
 size_t slist_count(Slist *list);
@@ -37,14 +77,27 @@ size_t slist_count(Slist *list);
 bool slist_isempty(struct Slist *list);
 
 
+// SlistNode init --- for nodes embedded in the caller's struct, data is
+// usually the container itself so data_cmp and data_equ see the whole struct
+void slist_node_init(SlistNode *node, void *data);
+
 // SlistNode free
 void slist_node_free(struct SlistNode *node);
+//give a node detached by remove_node_by_index back to the list's allocator,
+//required instead of slist_node_free when the list uses a pool.
+void slist_node_release(Slist *list, SlistNode *node);
+
+// SlistNode pool --- nodes are recycled instead of returned to the system
+SlistNodePool *slist_node_pool_create(size_t slab_nodes);
+SlistNodePool *slist_node_pool_create_inline(size_t slab_nodes, size_t data_size);
+void slist_node_pool_destroy(SlistNodePool *pool);
 
 
 // add_data --- !!!
 int slist_add_data_first(Slist *list, void *data);  // prepend  O(1) 
 int slist_add_data_last(Slist *list, void *data);   // append   O(1) or O(n)
-int slist_add_data_index(Slist *list, size_t index, void *data); //O(n)                       !!                    
+int slist_add_data_last_batch(Slist *list, void **data, size_t n); // O(n), one block and one splice
+int slist_add_data_index(Slist *list, size_t index, void *data); //O(n), O(logn) with index                       !!                    
 
 int slist_add_data_prev_node(Slist *list, SlistNode *anchor, void *data);
 int slist_add_data_next_node_safe  (Slist *list, SlistNode *anchor, void *data); // O(n)
@@ -79,8 +132,16 @@ SlistNode *remove_node_by_index(Slist *list, size_t index);
 
 void *remove_data_by_index(Slist *list, size_t index);
 
+// remove batch --- one pass, return the number removed
+size_t remove_data_first_batch(Slist *list, void **data, size_t n);
+size_t remove_data_by_index_batch(Slist *list, const size_t *indexes, size_t n, void **data);
+
 //get
 //get_nodeķһ㲻ȥdataģremoveժڵ㡣
+//node functions on a lazy copy first copy the nodes up to the one returned
+//into it, see lazy copy: slist_last_node copies every shared node, O(n).
+//NULL there also means out of memory; compare index with slist_count, or
+//check the data with slist_get_index_by_data, which never allocates.
 SlistNode *slist_get_node_by_index(Slist *list, size_t index);
 SlistNode *slist_get_node_by_data(Slist *list, void *data);
  
@@ -103,17 +164,177 @@ void *slist_first_data(Slist *list);
 
 //advanced method
 
+// relinking --- -1 only for a lazy copy or its source out of memory, see
+// lazy copy; the lists are left as they were and none is freed.
 // reverse --- O(n)
-void slist_reverse(struct Slist *list);
-
-// sort --- !!!
-void slist_sort(struct Slist *list);
-
-//sort merge
-void slist_sort_merge(Slist *list1, Slist *list2);
-
-//free list,append list to target.
-void slist_concat(Slist *target, Slist *list);
+int slist_reverse(struct Slist *list);
+
+// sort --- O(nlogn), stable, relinks nodes in place
+int slist_sort(struct Slist *list);
+
+//sort merge --- O(n+m), both lists sorted, list2 is merged into list1 and freed
+int slist_sort_merge(Slist *list1, Slist *list2);
+
+//free list,append list to target. O(1) on the same pool, see slist_splice
+int slist_concat(Slist *target, Slist *list);
+//move all nodes of list to the end of target, list stays empty. O(1) when
+//both lists use the same pool or both none. Otherwise O(m): list's nodes are
+//copied into target's allocator and given back to list's, -1 when out of
+//memory. Lists of different kinds (intrusive, inline data_size) give -1.
+//sort_merge and sorted_union move nodes between pools the same way.
+int slist_splice(Slist *target, Slist *list);
+
+//split --- the tail part moves to the returned list
+Slist *slist_split_at_index(Slist *list, size_t index);    // O(n), O(logn) with index
+Slist *slist_split_at_node(Slist *list, SlistNode *node);  // O(n), after node
+
+// sorted mode --- the list is known to be in data_cmp order. slist_sorted_enable
+// sorts it if it is not, slist_add_*_sorted keep the order, O(logn) with index
+// because the towers are in data_cmp order too. An insert, batch append or
+// splice out of order and a reverse end the mode; copies and splits inherit it.
+// -1 when the sort fails, see relinking.
+int slist_sorted_enable(Slist *list);
+void slist_sorted_disable(Slist *list);
+bool slist_issorted(Slist *list);
+
+// set algebra --- O(n+m), both lists in sorted mode, a data is in the other
+// list when data_cmp finds an equal one there. Nodes are relinked, and
+// copied only into list1's pool by a union across pools. When the list
+// searched (list1 for union, list2 otherwise) has a prefetch table and is 8
+// times longer or more, it is searched by galloping over the table instead
+// of walked: O(m log(n/m)) compares. -1 for out of memory, a mapped list1
+// or lists of different kinds; a union then moved nothing, an intersect or
+// difference on a lazy copy may have removed some nodes already.
+//nodes of list2 whose data are not in list1 move into list1, the others stay
+//in list2. returns the number moved.
+long slist_sorted_union(Slist *list1, Slist *list2);
+//nodes of list1 whose data are not in list2 are removed, data to data_free.
+//returns the number removed.
+long slist_sorted_intersect(Slist *list1, Slist *list2);
+//nodes of list1 whose data are in list2 are removed, data to data_free.
+//returns the number removed.
+long slist_sorted_difference(Slist *list1, Slist *list2);
+
+// cursor --- O(1) each, O(logn) with index
+void slist_cursor_init(SlistCursor *cursor, Slist *list);  // at the first node
+bool slist_cursor_next(SlistCursor *cursor);               // false at the end
+SlistNode *slist_cursor_node(SlistCursor *cursor);         // NULL at the end
+void *slist_cursor_peek(SlistCursor *cursor);              // NULL at the end
+int slist_cursor_insert_before(SlistCursor *cursor, void *data); // cursor stays on current
+int slist_cursor_insert_after(SlistCursor *cursor, void *data);
+void *slist_cursor_remove(SlistCursor *cursor);            // moves to the next node
+int slist_cursor_remove_deep(SlistCursor *cursor);         // data goes to data_free
+
+// index --- optional skip list kept by every insert and remove, makes
+// *_by_index and slist_add_data_index O(logn). Inserts next to an anchor node,
+// reverse and sort mark it stale, it is rebuilt on the next positional access.
+int slist_index_enable(Slist *list);
+void slist_index_disable(Slist *list);
+
+// hash --- optional table on data_hash kept by every insert and remove, makes
+// slist_get_node_by_data, remove_one_by_data and remove_all_by_data O(1) and a
+// miss in slist_get_index_by_data O(1). With equal data in the list a lookup
+// finds any one of them, not necessarily the first. Calling it again only
+// changes data_hash.
+int slist_hash_enable(Slist *list, SlistDataHash *data_hash);
+void slist_hash_disable(Slist *list);
+
+// prefetch --- optional table of the nodes in list order. Lookups by data or
+// node, remove_one/all_by_data and reverse walk it and prefetch distance nodes
+// ahead (0 picks 16), so a list bigger than the cache is scanned at memory
+// bandwidth instead of one miss per node. Appends keep it, other edits mark
+// it stale and it is rebuilt in one walk by the next scan; costs one pointer
+// per node. Calling it again only changes the distance.
+int slist_prefetch_enable(Slist *list, size_t distance);
+void slist_prefetch_disable(Slist *list);
+
+// compact --- move the nodes of a pooled list, in list order, into one block
+// taken from its pool and give the old nodes back, so scans run over adjacent
+// memory again after long churn. Moves at most max_nodes per call (0: all)
+// and returns how many are left, 0 once the whole list is laid out, -1 for a
+// list without pool, an intrusive list or out of memory. Data, order, count
+// and the side structures are kept, node addresses change. The list may be
+// edited between calls; an insert or remove next to an anchor node or a
+// reverse, sort or splice restarts the pass.
+long slist_compact(Slist *list, size_t max_nodes);
+
+// snapshot --- slist_snapshot_write stores the data by value, data_size bytes
+// each (0: the inline size of the list), in list order as fixed-size records
+// behind a header. The file holds offsets, no addresses, and is written in
+// large blocks. slist_snapshot_map maps it read only without copying: count,
+// isempty, first_data, last_data, get_data_by_index (O(1)) and
+// get_index_by_data read the records in place. The first node function or
+// cursor builds a table of nodes over the records, one SlistNode each, whose
+// data point into the file and are read only; out of memory there gives
+// NULL. Functions that would change the list fail with -1, NULL or 0 and
+// clear does nothing. slist_copy gives a writable inline list,
+// slist_destroy unmaps. Files are native endian.
+int slist_snapshot_write(Slist *list, const char *path, size_t data_size);
+Slist *slist_snapshot_map(const char *path, SlistDataCmp *data_cmp, SlistDataEqu *data_equ);
+
+// lazy copy --- slist_copy_lazy copies no node: the copy reads the last nodes
+// of its source until one of them is edited. count, isempty, first/last data
+// and every read work at once. An edit of the copy first copies the nodes up
+// to its position into it, so a prepend copies none and an append all of
+// them. An edit of the source first makes every copy reading the nodes there
+// copy them. The source keeps its nodes; node functions of the copy hand out
+// its own nodes only and reject the source's, so handles of either list stay
+// in it. A cursor on the copy ends with any edit of the source.
+// Reverse, sort, sort_merge, splice, concat, union, enabling a side structure
+// and compacting copy the whole list first, so do intersect and difference
+// for a list2 that is a copy of list1. Out of memory there fails the call as
+// for a new node and leaves the lists as they were; the set functions then
+// return -1. slist_unshare does the step alone and reports it. A list with
+// index, hash, prefetch table or compaction pass, intrusive or mapped is
+// copied eagerly. A source and its lazy copies are one object for threads:
+// use them from one thread.
+Slist *slist_copy_lazy(Slist *list);  // O(1), O(k) for a lazy copy owning k nodes
+bool slist_isshared(Slist *list);     // a lazy copy or the source of one
+int slist_unshare(Slist *list);       // O(k) for k shared nodes, -1 out of memory
+
+// stats --- per list counters, compiled in only when the library is built
+// with -DSLIST_STATS; without it nothing is counted and slist_get_stats
+// returns -1. A walk is one pass over nodes, or entries of a side structure,
+// made on behalf of an operation, a rebuild of a stale index, hash or
+// prefetch table included. walks[0] counts walks of no node, walks[k] those
+// of 2^(k-1) to 2^k - 1 nodes, the last bucket everything longer.
+#define SLIST_STATS_BUCKETS 32
+
+typedef enum SlistOp {
+	SLIST_OP_ADD_FIRST,        /* slist_add_*_first */
+	SLIST_OP_ADD_LAST,         /* slist_add_*_last, slist_add_data_last_batch */
+	SLIST_OP_ADD_INDEX,        /* slist_add_data_index */
+	SLIST_OP_ADD_ANCHOR,       /* slist_add_*_prev_node, slist_add_*_next_node* */
+	SLIST_OP_ADD_SORTED,       /* slist_add_*_sorted */
+	SLIST_OP_REMOVE_BY_DATA,   /* remove_one_by_data, remove_all_by_data */
+	SLIST_OP_REMOVE_BY_NODE,   /* remove_by_node */
+	SLIST_OP_REMOVE_BY_INDEX,  /* remove_*_by_index*, remove_data_first_batch */
+	SLIST_OP_GET_BY_INDEX,     /* slist_get_*_by_index */
+	SLIST_OP_GET_BY_DATA,      /* slist_get_node_by_data, slist_get_index_by_data, slist_get_node_custom */
+	SLIST_OP_GET_BY_NODE,      /* slist_get_index_by_node */
+	SLIST_OP_NODE_EXIST,       /* membership checks of slist_add_node_* and *_next_node */
+	SLIST_OP_CURSOR,           /* slist_cursor_insert_*, slist_cursor_remove */
+	SLIST_OP_REVERSE,
+	SLIST_OP_SORT,             /* slist_sort, slist_sort_merge */
+	SLIST_OP_SET,              /* slist_sorted_union, _intersect, _difference */
+	SLIST_OP_COPY,             /* slist_copy, slist_copy_deep */
+	SLIST_OP_SPLIT,            /* slist_split_at_* */
+	SLIST_OP_CLEAR,            /* slist_clear*, slist_destroy_deep */
+	SLIST_OP_COMPACT,
+	SLIST_OP_COUNT
+} SlistOp;
+
+typedef struct SlistStats {
+	size_t calls[SLIST_OP_COUNT];
+	size_t visited[SLIST_OP_COUNT];  /* nodes walked on behalf of each operation */
+	size_t allocs;                   /* nodes taken from malloc or the pool */
+	size_t frees;                    /* nodes given back */
+	size_t max_count;
+	size_t walks[SLIST_STATS_BUCKETS];
+} SlistStats;
+
+int slist_get_stats(Slist *list, SlistStats *stats);
+void slist_reset_stats(Slist *list);  // max_count restarts at the current count
 
 #endif //__SLIST_H__
 
@@ -0,0 +1,2920 @@
+/* benchmarks for the slist family, results go to stdout as JSON.
+
+   usage: slist_bench [-m max_size] [-w work] [-r repetitions] [-t max_threads] [-f filter]
+
+   list sizes run from 10 to max_size in powers of ten (default 10^6, 10^8
+   needs several GB). work bounds the elements one case touches, so an O(n)
+   operation runs work/n times and an O(1) one work/4 times. Setup is not
+   timed. allocs_per_op counts malloc, calloc, realloc and aligned_alloc when
+   linked with -Wl,--wrap (see Makefile), cache_misses_per_op comes from
+   perf_event_open where the kernel allows it, both are null otherwise. */
+
+#define _GNU_SOURCE
+
+#include "slist.h"
+#include "slist_unrolled.h"
+#include "slist_concurrent.h"
+#include "slist_parallel.h"
+#include "slist_persistent.h"
+#include "slist_heap.h"
+#include "slist_ring.h"
+#include "slist_typed.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#define BENCH_BATCH 64          /* elements per batch call */
+#define BENCH_HEAVY 32          /* rounds of the cpu heavy callback */
+
+enum {
+	BENCH_CONST,      /* O(1) per op, runs work/4 ops */
+	BENCH_LINEAR,     /* O(n) per op or a fresh list per op, runs work/n ops */
+	BENCH_THREADS     /* runs once per thread count, size is the item count */
+};
+
+enum {
+	BENCH_ORDERED,
+	BENCH_SHUFFLED,
+	BENCH_SCATTERED   /* data in order, nodes out of address order */
+};
+
+/* side structure a lookup case enables on its lists */
+enum {
+	BENCH_WALK,
+	BENCH_HASH,
+	BENCH_PREFETCH
+};
+
+typedef struct Bench {
+	size_t n;             /* list size */
+	size_t ops;           /* operations the case times */
+	int threads;
+	uint64_t rng;
+
+	uint64_t t0, ns;
+	size_t a0, allocs;
+	uint64_t m0, misses;
+} Bench;
+
+typedef void BenchFunc(Bench *b);
+
+typedef struct BenchCase {
+	const char *name;
+	BenchFunc *func;
+	int scale;
+} BenchCase;
+
+static long *bench_vals;          /* bench_vals[i] == i, list data points in here */
+static long bench_missing = -1;
+static long bench_filler = 0;      /* data of lists built while bench_vals is gone */
+static volatile uintptr_t bench_sink;
+
+#define BENCH_DATA(i) ((void *)&bench_vals[(i)])
+
+SLIST_DEFINE(bench_typed, long, SLIST_VALUE_CMP, SLIST_VALUE_EQU)
+
+static atomic_size_t bench_alloc_count;
+static int bench_perf_fd = -1;
+
+// allocation counting --- the linker sends malloc and friends through here
+#ifdef SLIST_BENCH_ALLOCS
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+void *__wrap_aligned_alloc(size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+	atomic_fetch_add_explicit(&bench_alloc_count, 1, memory_order_relaxed);
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+	atomic_fetch_add_explicit(&bench_alloc_count, 1, memory_order_relaxed);
+	return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	atomic_fetch_add_explicit(&bench_alloc_count, 1, memory_order_relaxed);
+	return __real_realloc(ptr, size);
+}
+
+void *__wrap_aligned_alloc(size_t alignment, size_t size)
+{
+	atomic_fetch_add_explicit(&bench_alloc_count, 1, memory_order_relaxed);
+	return __real_aligned_alloc(alignment, size);
+}
+#endif
+
+// timing
+static void bench_perf_open(void)
+{
+#ifdef __linux__
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.inherit = 1;     /* count worker threads too */
+
+	bench_perf_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+	return;
+}
+
+static uint64_t bench_perf_read(void)
+{
+	uint64_t value = 0;
+
+	if (bench_perf_fd < 0) return 0;
+	if (read(bench_perf_fd, &value, sizeof(value)) != (ssize_t)sizeof(value)) return 0;
+
+	return value;
+}
+
+static uint64_t bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* a case may start and stop several times, the intervals add up */
+static void bench_start(Bench *b)
+{
+	b->a0 = atomic_load(&bench_alloc_count);
+	b->m0 = bench_perf_read();
+	b->t0 = bench_now();
+
+	return;
+}
+
+static void bench_stop(Bench *b)
+{
+	uint64_t t1 = 0;
+
+	t1 = bench_now();
+	b->misses += bench_perf_read() - b->m0;
+	b->allocs += atomic_load(&bench_alloc_count) - b->a0;
+	b->ns += t1 - b->t0;
+
+	return;
+}
+
+// helpers
+static void *bench_check(void *p)
+{
+	if (p == NULL) {
+		fprintf(stderr, "slist_bench: out of memory\n");
+		exit(1);
+	}
+
+	return p;
+}
+
+static uint64_t bench_rand(Bench *b)
+{
+	b->rng ^= b->rng << 13;
+	b->rng ^= b->rng >> 7;
+	b->rng ^= b->rng << 17;
+
+	return b->rng;
+}
+
+static size_t bench_rand_below(Bench *b, size_t bound)
+{
+	return bound ? (size_t)(bench_rand(b) % bound) : 0;
+}
+
+static int bench_data_cmp(void *data1, void *data2)
+{
+	long a = *(long *)data1, b = *(long *)data2;
+
+	return (a > b) - (a < b);
+}
+
+static bool bench_data_equ(void *data1, void *data2)
+{
+	return *(long *)data1 == *(long *)data2;
+}
+
+static void *bench_data_copy(void *data)
+{
+	long *copy = NULL;
+
+	copy = (long *)malloc(sizeof(long));
+	if (copy) *copy = *(long *)data;
+
+	return copy;
+}
+
+static void bench_data_free(void *data)
+{
+	free(data);
+
+	return;
+}
+
+static void bench_data_free_batch(void **data, size_t n)
+{
+	size_t i = 0;
+
+	for (i = 0; i < n; i++) free(data[i]);
+
+	return;
+}
+
+static size_t bench_data_hash(void *data)
+{
+	return (size_t)*(long *)data * (size_t)0x9E3779B97F4A7C15u;
+}
+
+static int bench_data_find(void *data, void *user_data)
+{
+	return *(long *)data == *(long *)user_data ? 0 : 1;
+}
+
+static int bench_qsort_cmp(const void *p1, const void *p2)
+{
+	return bench_data_cmp(*(void * const *)p1, *(void * const *)p2);
+}
+
+/* stands in for a cpu heavy per element callback */
+static uintptr_t bench_heavy(void *data)
+{
+	uint64_t x = (uint64_t)*(long *)data + 1;
+	int i = 0;
+
+	for (i = 0; i < BENCH_HEAVY; i++)
+		x = x * 6364136223846793005u + 1442695040888963407u;
+
+	return (uintptr_t)(x >> 32);
+}
+
+static size_t *bench_perm(Bench *b, size_t n)
+{
+	size_t *perm = NULL, i = 0, j = 0, t = 0;
+
+	perm = (size_t *)bench_check(malloc((n ? n : 1) * sizeof(size_t)));
+	for (i = 0; i < n; i++) perm[i] = i;
+	for (i = n; i > 1; i--) {
+		j = bench_rand_below(b, i);
+		t = perm[i - 1]; perm[i - 1] = perm[j]; perm[j] = t;
+	}
+
+	return perm;
+}
+
+static Slist *bench_list(Bench *b, int order, SlistNodePool *pool)
+{
+	Slist *list = NULL;
+	size_t *perm = NULL, i = 0;
+
+	/* the data are borrowed from bench_vals, nothing to free */
+	list = (Slist *)bench_check(slist_create_pool(bench_data_cmp, bench_data_equ, bench_data_copy, NULL, pool));
+
+	if (order != BENCH_ORDERED) perm = bench_perm(b, b->n);
+	for (i = 0; i < b->n; i++) {
+		if (slist_add_data_last(list, BENCH_DATA(perm ? perm[i] : i)) != 0)
+			bench_check(NULL);
+	}
+	free(perm);
+
+	/* nodes were allocated in shuffled order, so no hardware prefetcher can
+	   guess the next one once the data are sorted back */
+	if (order == BENCH_SCATTERED) slist_sort(list);
+
+	return list;
+}
+
+static void bench_list_side(Slist *list, int side)
+{
+	if (side == BENCH_HASH && slist_hash_enable(list, bench_data_hash) != 0) bench_check(NULL);
+	if (side == BENCH_PREFETCH && slist_prefetch_enable(list, 0) != 0) bench_check(NULL);
+
+	return;
+}
+
+static Slist **bench_lists(Bench *b, size_t k, int order)
+{
+	Slist **lists = NULL;
+	size_t i = 0;
+
+	lists = (Slist **)bench_check(malloc(k * sizeof(Slist *)));
+	for (i = 0; i < k; i++) lists[i] = bench_list(b, order, NULL);
+
+	return lists;
+}
+
+static void bench_lists_destroy(Slist **lists, size_t k)
+{
+	size_t i = 0;
+
+	for (i = 0; i < k; i++) {
+		if (lists[i]) slist_destroy_deep(lists[i]);
+	}
+	free(lists);
+
+	return;
+}
+
+/* enough lists of n for ops operations that each use up one element */
+static size_t bench_list_count(Bench *b)
+{
+	return (b->ops + b->n - 1) / b->n;
+}
+
+/* data stored by value in the nodes */
+static Slist *bench_list_inline(Bench *b)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = (Slist *)bench_check(slist_create_inline(sizeof(long), bench_data_cmp, bench_data_equ, NULL));
+	for (i = 0; i < b->n; i++) {
+		if (slist_add_data_last(list, BENCH_DATA(i)) != 0) bench_check(NULL);
+	}
+
+	return list;
+}
+
+/* list data are own copies, for the deep cases */
+static Slist *bench_list_owned(Bench *b)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = (Slist *)bench_check(slist_create_full(bench_data_cmp, bench_data_equ, bench_data_copy, bench_data_free));
+	for (i = 0; i < b->n; i++) {
+		if (slist_add_data_last(list, bench_check(bench_data_copy(BENCH_DATA(i)))) != 0)
+			bench_check(NULL);
+	}
+
+	return list;
+}
+
+/* detached nodes for the add_node cases, the list frees them */
+static SlistNode **bench_nodes(Bench *b, size_t count)
+{
+	SlistNode **nodes = NULL;
+	size_t i = 0;
+
+	nodes = (SlistNode **)bench_check(malloc((count ? count : 1) * sizeof(SlistNode *)));
+	for (i = 0; i < count; i++) {
+		nodes[i] = (SlistNode *)bench_check(malloc(sizeof(SlistNode)));
+		slist_node_init(nodes[i], BENCH_DATA(bench_rand_below(b, b->n)));
+	}
+
+	return nodes;
+}
+
+/* every node of list in list order */
+static SlistNode **bench_list_nodes(Slist *list)
+{
+	SlistNode **nodes = NULL, *p = NULL;
+	size_t i = 0;
+
+	nodes = (SlistNode **)bench_check(malloc((slist_count(list) + 1) * sizeof(SlistNode *)));
+	for (p = slist_first_node(list); p; p = p->next) nodes[i++] = p;
+
+	return nodes;
+}
+
+// add_data
+static void bench_add_data_first(Bench *b)
+{
+	Slist **lists = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			slist_add_data_first(lists[j], BENCH_DATA(m));
+	}
+	bench_stop(b);
+
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_add_data_last_with(Bench *b, SlistNodePool *pool)
+{
+	Slist **lists = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0;
+
+	k = bench_list_count(b);
+	lists = (Slist **)bench_check(malloc(k * sizeof(Slist *)));
+	for (j = 0; j < k; j++) lists[j] = bench_list(b, BENCH_ORDERED, pool);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			slist_add_data_last(lists[j], BENCH_DATA(m));
+	}
+	bench_stop(b);
+
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_add_data_last(Bench *b)
+{
+	bench_add_data_last_with(b, NULL);
+
+	return;
+}
+
+static void bench_add_data_last_pool(Bench *b)
+{
+	SlistNodePool *pool = NULL;
+
+	pool = (SlistNodePool *)bench_check(slist_node_pool_create(1024));
+	bench_add_data_last_with(b, pool);
+	slist_node_pool_destroy(pool);
+
+	return;
+}
+
+static void bench_add_data_last_batch_with(Bench *b, SlistNodePool *pool)
+{
+	Slist **lists = NULL;
+	void *data[BENCH_BATCH];
+	size_t k = 0, i = 0, j = 0, m = 0, step = 0;
+
+	for (m = 0; m < BENCH_BATCH; m++) data[m] = BENCH_DATA(m % b->n);
+
+	k = bench_list_count(b);
+	lists = (Slist **)bench_check(malloc(k * sizeof(Slist *)));
+	for (j = 0; j < k; j++) lists[j] = bench_list(b, BENCH_ORDERED, pool);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m += step, i += step) {
+			step = BENCH_BATCH;
+			if (step > b->n - m) step = b->n - m;
+			if (step > b->ops - i) step = b->ops - i;
+			slist_add_data_last_batch(lists[j], data, step);
+		}
+	}
+	bench_stop(b);
+
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_add_data_last_batch(Bench *b)
+{
+	bench_add_data_last_batch_with(b, NULL);
+
+	return;
+}
+
+static void bench_add_data_last_batch_pool(Bench *b)
+{
+	SlistNodePool *pool = NULL;
+
+	pool = (SlistNodePool *)bench_check(slist_node_pool_create(1024));
+	bench_add_data_last_batch_with(b, pool);
+	slist_node_pool_destroy(pool);
+
+	return;
+}
+
+enum {
+	BENCH_ADD_DATA_INDEX,
+	BENCH_ADD_DATA_PREV_NODE,
+	BENCH_ADD_DATA_NEXT_NODE_SAFE,
+	BENCH_ADD_DATA_SORTED,
+	BENCH_ADD_NODE_PREV_NODE,
+	BENCH_ADD_NODE_NEXT_NODE,
+	BENCH_ADD_NODE_SORTED
+};
+
+/* O(n) inserts, every list takes n of them so it stays below 2n. The anchor
+   is the last node, so the searches for it walk the whole list. */
+static void bench_add_walk_with(Bench *b, int op, bool index)
+{
+	Slist **lists = NULL;
+	SlistNode **nodes = NULL, *anchor = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0, *val = NULL;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+	for (j = 0; index && j < k; j++) {
+		if (slist_index_enable(lists[j]) != 0) bench_check(NULL);
+		if (op == BENCH_ADD_DATA_SORTED) slist_sorted_enable(lists[j]); /* sorted inserts descend the towers */
+	}
+	if (op >= BENCH_ADD_NODE_PREV_NODE) nodes = bench_nodes(b, b->ops);
+	val = (size_t *)bench_check(malloc(b->ops * sizeof(size_t)));
+	for (i = 0; i < b->ops; i++) {
+		if (op == BENCH_ADD_DATA_INDEX)
+			val[i] = bench_rand_below(b, b->n + i % b->n + 1);
+		else
+			val[i] = bench_rand_below(b, b->n);
+	}
+
+	bench_start(b);
+	for (i = 0, j = 0; i < b->ops; j++) {
+		anchor = slist_last_node(lists[j]);
+		for (m = 0; m < b->n && i < b->ops; m++, i++) {
+			switch (op) {
+			case BENCH_ADD_DATA_INDEX:
+				slist_add_data_index(lists[j], val[i], BENCH_DATA(m));
+				break;
+			case BENCH_ADD_DATA_PREV_NODE:
+				slist_add_data_prev_node(lists[j], anchor, BENCH_DATA(m));
+				break;
+			case BENCH_ADD_DATA_NEXT_NODE_SAFE:
+				slist_add_data_next_node_safe(lists[j], anchor, BENCH_DATA(m));
+				break;
+			case BENCH_ADD_DATA_SORTED:
+				slist_add_data_sorted(lists[j], BENCH_DATA(val[i]));
+				break;
+			case BENCH_ADD_NODE_PREV_NODE:
+				slist_add_node_prev_node(lists[j], anchor, nodes[i]);
+				break;
+			case BENCH_ADD_NODE_NEXT_NODE:
+				slist_add_node_next_node(lists[j], anchor, nodes[i]);
+				break;
+			case BENCH_ADD_NODE_SORTED:
+				slist_add_node_sorted(lists[j], nodes[i]);
+				break;
+			}
+		}
+	}
+	bench_stop(b);
+
+	free(val);
+	free(nodes);
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_add_data_index(Bench *b)          { bench_add_walk_with(b, BENCH_ADD_DATA_INDEX, false);          return; }
+static void bench_add_data_index_indexed(Bench *b)  { bench_add_walk_with(b, BENCH_ADD_DATA_INDEX, true);           return; }
+static void bench_add_data_prev_node(Bench *b)      { bench_add_walk_with(b, BENCH_ADD_DATA_PREV_NODE, false);      return; }
+static void bench_add_data_next_node_safe(Bench *b) { bench_add_walk_with(b, BENCH_ADD_DATA_NEXT_NODE_SAFE, false); return; }
+static void bench_add_data_sorted(Bench *b)         { bench_add_walk_with(b, BENCH_ADD_DATA_SORTED, false);         return; }
+static void bench_add_data_sorted_indexed(Bench *b) { bench_add_walk_with(b, BENCH_ADD_DATA_SORTED, true);          return; }
+static void bench_add_node_prev_node(Bench *b)      { bench_add_walk_with(b, BENCH_ADD_NODE_PREV_NODE, false);      return; }
+static void bench_add_node_next_node(Bench *b)      { bench_add_walk_with(b, BENCH_ADD_NODE_NEXT_NODE, false);      return; }
+static void bench_add_node_sorted(Bench *b)         { bench_add_walk_with(b, BENCH_ADD_NODE_SORTED, false);         return; }
+
+static void bench_add_data_next_node_unsafe(Bench *b)
+{
+	Slist **lists = NULL;
+	SlistNode *anchor = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		anchor = slist_first_node(lists[j]);
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			slist_add_data_next_node_unsafe(lists[j], anchor, BENCH_DATA(m));
+	}
+	bench_stop(b);
+
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+// add_node --- every entry point first checks the node is not in the list, O(n)
+static void bench_add_node_first(Bench *b)
+{
+	Slist **lists = NULL;
+	SlistNode **nodes = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+	nodes = bench_nodes(b, b->ops);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			slist_add_node_first(lists[j], nodes[i]);
+	}
+	bench_stop(b);
+
+	free(nodes);
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_add_node_last(Bench *b)
+{
+	Slist **lists = NULL;
+	SlistNode **nodes = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+	nodes = bench_nodes(b, b->ops);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			slist_add_node_last(lists[j], nodes[i]);
+	}
+	bench_stop(b);
+
+	free(nodes);
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_add_node_next_node_unsafe(Bench *b)
+{
+	Slist **lists = NULL;
+	SlistNode **nodes = NULL, *anchor = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+	nodes = bench_nodes(b, b->ops);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		anchor = slist_first_node(lists[j]);
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			slist_add_node_next_node_unsafe(lists[j], anchor, nodes[i]);
+	}
+	bench_stop(b);
+
+	free(nodes);
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+// remove
+/* every list loses its data in one shuffled order */
+static void bench_remove_by_data_with(Bench *b, bool all, int order, int side)
+{
+	Slist **lists = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0, *perm = NULL;
+
+	k = bench_list_count(b);
+	lists = (Slist **)bench_check(malloc(k * sizeof(Slist *)));
+	for (j = 0; j < k; j++) {
+		lists[j] = bench_list(b, order, NULL);
+		bench_list_side(lists[j], side);
+	}
+	perm = bench_perm(b, b->n);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m++, i++) {
+			if (all)
+				remove_all_by_data(lists[j], BENCH_DATA(perm[m]));
+			else
+				remove_one_by_data(lists[j], BENCH_DATA(perm[m]));
+		}
+	}
+	bench_stop(b);
+
+	free(perm);
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_remove_one_by_data(Bench *b)
+{
+	bench_remove_by_data_with(b, false, BENCH_ORDERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_remove_one_by_data_hashed(Bench *b)
+{
+	bench_remove_by_data_with(b, false, BENCH_ORDERED, BENCH_HASH);
+
+	return;
+}
+
+static void bench_remove_all_by_data(Bench *b)
+{
+	bench_remove_by_data_with(b, true, BENCH_ORDERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_remove_all_by_data_scattered(Bench *b)
+{
+	bench_remove_by_data_with(b, true, BENCH_SCATTERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_remove_all_by_data_prefetch(Bench *b)
+{
+	bench_remove_by_data_with(b, true, BENCH_SCATTERED, BENCH_PREFETCH);
+
+	return;
+}
+
+static void bench_remove_by_node(Bench *b)
+{
+	Slist **lists = NULL;
+	SlistNode ***nodes = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0, *perm = NULL;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+	nodes = (SlistNode ***)bench_check(malloc(k * sizeof(SlistNode **)));
+	for (j = 0; j < k; j++) nodes[j] = bench_list_nodes(lists[j]);
+	perm = bench_perm(b, b->n);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			remove_by_node(lists[j], nodes[j][perm[m]]);
+	}
+	bench_stop(b);
+
+	for (j = 0; j < k; j++) free(nodes[j]);
+	free(nodes);
+	free(perm);
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+/* removed nodes are released after the clock stops */
+static void bench_remove_node_by_index_with(Bench *b, bool index)
+{
+	Slist **lists = NULL;
+	SlistNode **removed = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0, *pos = NULL;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+	for (j = 0; index && j < k; j++) {
+		if (slist_index_enable(lists[j]) != 0) bench_check(NULL);
+	}
+	removed = (SlistNode **)bench_check(malloc(b->ops * sizeof(SlistNode *)));
+	pos = (size_t *)bench_check(malloc(b->ops * sizeof(size_t)));
+	for (i = 0; i < b->ops; i++) pos[i] = bench_rand_below(b, b->n - i % b->n);
+
+	bench_start(b);
+	for (i = 0, j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			removed[i] = remove_node_by_index(lists[j], pos[i]);
+	}
+	bench_stop(b);
+
+	for (i = 0, j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			slist_node_release(lists[j], removed[i]);
+	}
+	free(pos);
+	free(removed);
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_remove_node_by_index(Bench *b)
+{
+	bench_remove_node_by_index_with(b, false);
+
+	return;
+}
+
+static void bench_remove_node_by_index_indexed(Bench *b)
+{
+	bench_remove_node_by_index_with(b, true);
+
+	return;
+}
+
+static void bench_remove_data_by_index_with(Bench *b, bool index)
+{
+	Slist **lists = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0, *pos = NULL;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+	for (j = 0; index && j < k; j++) {
+		if (slist_index_enable(lists[j]) != 0) bench_check(NULL);
+	}
+	pos = (size_t *)bench_check(malloc(b->ops * sizeof(size_t)));
+	for (i = 0; i < b->ops; i++) pos[i] = bench_rand_below(b, b->n - i % b->n);
+
+	bench_start(b);
+	for (i = 0, j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			bench_sink += (uintptr_t)remove_data_by_index(lists[j], pos[i]);
+	}
+	bench_stop(b);
+
+	free(pos);
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_remove_data_by_index(Bench *b)
+{
+	bench_remove_data_by_index_with(b, false);
+
+	return;
+}
+
+static void bench_remove_data_by_index_indexed(Bench *b)
+{
+	bench_remove_data_by_index_with(b, true);
+
+	return;
+}
+
+static void bench_remove_data_by_index_first(Bench *b)
+{
+	Slist **lists = NULL;
+	size_t k = 0, i = 0, j = 0, m = 0;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			bench_sink += (uintptr_t)remove_data_by_index(lists[j], 0);
+	}
+	bench_stop(b);
+
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_remove_data_first_batch(Bench *b)
+{
+	Slist **lists = NULL;
+	void *data[BENCH_BATCH];
+	size_t k = 0, i = 0, j = 0, m = 0, step = 0;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		for (m = 0; m < b->n && i < b->ops; m += step, i += step) {
+			step = BENCH_BATCH;
+			if (step > b->n - m) step = b->n - m;
+			if (step > b->ops - i) step = b->ops - i;
+			remove_data_first_batch(lists[j], data, step);
+		}
+	}
+	bench_stop(b);
+
+	bench_sink += (uintptr_t)data[0];
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+/* one call takes BENCH_BATCH spread out indexes from a fresh list */
+static void bench_remove_data_by_index_batch(Bench *b)
+{
+	Slist **lists = NULL;
+	void *data[BENCH_BATCH];
+	size_t indexes[BENCH_BATCH];
+	size_t i = 0, m = 0, count = 0;
+
+	count = b->n < BENCH_BATCH ? b->n : BENCH_BATCH;
+	for (m = 0; m < count; m++) indexes[m] = m * (b->n / count);
+	lists = bench_lists(b, b->ops, BENCH_ORDERED);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		remove_data_by_index_batch(lists[i], indexes, count, data);
+	bench_stop(b);
+
+	bench_sink += (uintptr_t)data[0];
+	bench_lists_destroy(lists, b->ops);
+
+	return;
+}
+
+/* steady push back, pop front on one list of n */
+static void bench_queue_churn_with(Bench *b, SlistNodePool *pool)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = bench_list(b, BENCH_ORDERED, pool);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		slist_add_data_last(list, BENCH_DATA(i % b->n));
+		bench_sink += (uintptr_t)remove_data_by_index(list, 0);
+	}
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_queue_churn(Bench *b)
+{
+	bench_queue_churn_with(b, NULL);
+
+	return;
+}
+
+static void bench_queue_churn_pool(Bench *b)
+{
+	SlistNodePool *pool = NULL;
+
+	pool = (SlistNodePool *)bench_check(slist_node_pool_create(1024));
+	bench_queue_churn_with(b, pool);
+	slist_node_pool_destroy(pool);
+
+	return;
+}
+
+// get
+static void bench_get_by_index_with(Bench *b, bool node, bool index)
+{
+	Slist *list = NULL;
+	size_t i = 0, *pos = NULL;
+
+	list = bench_list(b, BENCH_ORDERED, NULL);
+	if (index && slist_index_enable(list) != 0) bench_check(NULL);
+	pos = (size_t *)bench_check(malloc(b->ops * sizeof(size_t)));
+	for (i = 0; i < b->ops; i++) pos[i] = bench_rand_below(b, b->n);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		if (node)
+			bench_sink += (uintptr_t)slist_get_node_by_index(list, pos[i]);
+		else
+			bench_sink += (uintptr_t)slist_get_data_by_index(list, pos[i]);
+	}
+	bench_stop(b);
+
+	free(pos);
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_get_node_by_index(Bench *b)
+{
+	bench_get_by_index_with(b, true, false);
+
+	return;
+}
+
+static void bench_get_node_by_index_indexed(Bench *b)
+{
+	bench_get_by_index_with(b, true, true);
+
+	return;
+}
+
+static void bench_get_data_by_index(Bench *b)
+{
+	bench_get_by_index_with(b, false, false);
+
+	return;
+}
+
+static void bench_get_data_by_index_indexed(Bench *b)
+{
+	bench_get_by_index_with(b, false, true);
+
+	return;
+}
+
+enum {
+	BENCH_GET_NODE_BY_DATA,
+	BENCH_GET_INDEX_BY_DATA,
+	BENCH_GET_INDEX_BY_NODE,
+	BENCH_GET_NODE_CUSTOM
+};
+
+static void bench_get_by_data_with(Bench *b, int op, int order, int side)
+{
+	Slist *list = NULL;
+	SlistNode **nodes = NULL;
+	size_t i = 0, *val = NULL;
+
+	list = bench_list(b, order, NULL);
+	bench_list_side(list, side);
+	nodes = bench_list_nodes(list);
+	val = (size_t *)bench_check(malloc(b->ops * sizeof(size_t)));
+	for (i = 0; i < b->ops; i++) val[i] = bench_rand_below(b, b->n);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		switch (op) {
+		case BENCH_GET_NODE_BY_DATA:
+			bench_sink += (uintptr_t)slist_get_node_by_data(list, BENCH_DATA(val[i]));
+			break;
+		case BENCH_GET_INDEX_BY_DATA:
+			bench_sink += (uintptr_t)slist_get_index_by_data(list, BENCH_DATA(val[i]));
+			break;
+		case BENCH_GET_INDEX_BY_NODE:
+			bench_sink += (uintptr_t)slist_get_index_by_node(list, nodes[val[i]]);
+			break;
+		case BENCH_GET_NODE_CUSTOM:
+			bench_sink += (uintptr_t)slist_get_node_custom(list, bench_data_find, BENCH_DATA(val[i]));
+			break;
+		}
+	}
+	bench_stop(b);
+
+	free(val);
+	free(nodes);
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_get_node_by_data(Bench *b)
+{
+	bench_get_by_data_with(b, BENCH_GET_NODE_BY_DATA, BENCH_ORDERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_get_node_by_data_hashed(Bench *b)
+{
+	bench_get_by_data_with(b, BENCH_GET_NODE_BY_DATA, BENCH_ORDERED, BENCH_HASH);
+
+	return;
+}
+
+static void bench_get_node_by_data_scattered(Bench *b)
+{
+	bench_get_by_data_with(b, BENCH_GET_NODE_BY_DATA, BENCH_SCATTERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_get_node_by_data_prefetch(Bench *b)
+{
+	bench_get_by_data_with(b, BENCH_GET_NODE_BY_DATA, BENCH_SCATTERED, BENCH_PREFETCH);
+
+	return;
+}
+
+static void bench_get_index_by_data(Bench *b)
+{
+	bench_get_by_data_with(b, BENCH_GET_INDEX_BY_DATA, BENCH_ORDERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_get_index_by_node(Bench *b)
+{
+	bench_get_by_data_with(b, BENCH_GET_INDEX_BY_NODE, BENCH_ORDERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_get_index_by_node_scattered(Bench *b)
+{
+	bench_get_by_data_with(b, BENCH_GET_INDEX_BY_NODE, BENCH_SCATTERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_get_index_by_node_prefetch(Bench *b)
+{
+	bench_get_by_data_with(b, BENCH_GET_INDEX_BY_NODE, BENCH_SCATTERED, BENCH_PREFETCH);
+
+	return;
+}
+
+static void bench_get_node_custom(Bench *b)
+{
+	bench_get_by_data_with(b, BENCH_GET_NODE_CUSTOM, BENCH_ORDERED, BENCH_WALK);
+
+	return;
+}
+
+enum {
+	BENCH_FIRST_NODE,
+	BENCH_FIRST_DATA,
+	BENCH_LAST_NODE,
+	BENCH_LAST_DATA,
+	BENCH_COUNT,
+	BENCH_ISEMPTY
+};
+
+static void bench_ends_with(Bench *b, int op)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = bench_list(b, BENCH_ORDERED, NULL);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		switch (op) {
+		case BENCH_FIRST_NODE: bench_sink += (uintptr_t)slist_first_node(list); break;
+		case BENCH_FIRST_DATA: bench_sink += (uintptr_t)slist_first_data(list); break;
+		case BENCH_LAST_NODE:  bench_sink += (uintptr_t)slist_last_node(list); break;
+		case BENCH_LAST_DATA:  bench_sink += (uintptr_t)slist_last_data(list); break;
+		case BENCH_COUNT:      bench_sink += (uintptr_t)slist_count(list); break;
+		case BENCH_ISEMPTY:    bench_sink += (uintptr_t)slist_isempty(list); break;
+		}
+	}
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_first_node(Bench *b) { bench_ends_with(b, BENCH_FIRST_NODE); return; }
+static void bench_first_data(Bench *b) { bench_ends_with(b, BENCH_FIRST_DATA); return; }
+static void bench_last_node(Bench *b)  { bench_ends_with(b, BENCH_LAST_NODE);  return; }
+static void bench_last_data(Bench *b)  { bench_ends_with(b, BENCH_LAST_DATA);  return; }
+static void bench_count(Bench *b)      { bench_ends_with(b, BENCH_COUNT);      return; }
+static void bench_isempty(Bench *b)    { bench_ends_with(b, BENCH_ISEMPTY);    return; }
+
+// cursor
+static void bench_cursor_next(Bench *b)
+{
+	Slist *list = NULL;
+	SlistCursor cursor;
+	size_t i = 0;
+
+	list = bench_list(b, BENCH_ORDERED, NULL);
+	slist_cursor_init(&cursor, list);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		bench_sink += (uintptr_t)slist_cursor_peek(&cursor);
+		if (!slist_cursor_next(&cursor)) slist_cursor_init(&cursor, list);
+	}
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_cursor_insert_after(Bench *b)
+{
+	Slist **lists = NULL;
+	SlistCursor cursor;
+	size_t k = 0, i = 0, j = 0, m = 0;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		slist_cursor_init(&cursor, lists[j]);
+		for (m = 0; m < b->n && i < b->ops; m++, i++) {
+			slist_cursor_insert_after(&cursor, BENCH_DATA(m));
+			slist_cursor_next(&cursor);
+		}
+	}
+	bench_stop(b);
+
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+static void bench_cursor_remove(Bench *b)
+{
+	Slist **lists = NULL;
+	SlistCursor cursor;
+	size_t k = 0, i = 0, j = 0, m = 0;
+
+	k = bench_list_count(b);
+	lists = bench_lists(b, k, BENCH_ORDERED);
+
+	bench_start(b);
+	for (j = 0; i < b->ops; j++) {
+		slist_cursor_init(&cursor, lists[j]);
+		for (m = 0; m < b->n && i < b->ops; m++, i++)
+			bench_sink += (uintptr_t)slist_cursor_remove(&cursor);
+	}
+	bench_stop(b);
+
+	bench_lists_destroy(lists, k);
+
+	return;
+}
+
+/* drop the odd values of a fresh list in one cursor pass */
+static void bench_filter_cursor(Bench *b)
+{
+	Slist **lists = NULL;
+	SlistCursor cursor;
+	size_t i = 0;
+
+	lists = bench_lists(b, b->ops, BENCH_ORDERED);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		slist_cursor_init(&cursor, lists[i]);
+		while (slist_cursor_node(&cursor)) {
+			if (*(long *)slist_cursor_peek(&cursor) & 1)
+				slist_cursor_remove(&cursor);
+			else
+				slist_cursor_next(&cursor);
+		}
+	}
+	bench_stop(b);
+
+	bench_lists_destroy(lists, b->ops);
+
+	return;
+}
+
+// whole list
+static void bench_reverse_with(Bench *b, int order, int side)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = bench_list(b, order, NULL);
+	bench_list_side(list, side);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		slist_reverse(list);
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_reverse(Bench *b)
+{
+	bench_reverse_with(b, BENCH_ORDERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_reverse_scattered(Bench *b)
+{
+	bench_reverse_with(b, BENCH_SCATTERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_reverse_prefetch(Bench *b)
+{
+	bench_reverse_with(b, BENCH_SCATTERED, BENCH_PREFETCH);
+
+	return;
+}
+
+static void bench_sort(Bench *b)
+{
+	Slist **lists = NULL;
+	size_t i = 0;
+
+	lists = bench_lists(b, b->ops, BENCH_SHUFFLED);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		slist_sort(lists[i]);
+	bench_stop(b);
+
+	bench_lists_destroy(lists, b->ops);
+
+	return;
+}
+
+/* the old way: copy the data out, qsort, write them back */
+static void bench_sort_qsort(Bench *b)
+{
+	Slist **lists = NULL;
+	SlistNode *p = NULL;
+	void **data = NULL;
+	size_t i = 0, m = 0;
+
+	lists = bench_lists(b, b->ops, BENCH_SHUFFLED);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		data = (void **)bench_check(malloc(b->n * sizeof(void *)));
+		for (p = slist_first_node(lists[i]), m = 0; p; p = p->next) data[m++] = p->data;
+		qsort(data, b->n, sizeof(void *), bench_qsort_cmp);
+		for (p = slist_first_node(lists[i]), m = 0; p; p = p->next) p->data = data[m++];
+		free(data);
+	}
+	bench_stop(b);
+
+	bench_lists_destroy(lists, b->ops);
+
+	return;
+}
+
+static void bench_sort_merge(Bench *b)
+{
+	Slist **lists1 = NULL, **lists2 = NULL;
+	size_t i = 0;
+
+	lists1 = bench_lists(b, b->ops, BENCH_ORDERED);
+	lists2 = bench_lists(b, b->ops, BENCH_ORDERED);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		slist_sort_merge(lists1[i], lists2[i]);
+	bench_stop(b);
+
+	free(lists2);
+	bench_lists_destroy(lists1, b->ops);
+
+	return;
+}
+
+/* every stride-th value below n, in sorted mode */
+static Slist *bench_sorted_list(Bench *b, size_t stride, int side)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = (Slist *)bench_check(slist_create_full(bench_data_cmp, bench_data_equ, bench_data_copy, NULL));
+	for (i = 0; i < b->n; i += stride) {
+		if (slist_add_data_last(list, BENCH_DATA(i)) != 0) bench_check(NULL);
+	}
+	slist_sorted_enable(list);
+	bench_list_side(list, side);
+
+	return list;
+}
+
+/* the short list is a subset of the long one: union moves nothing and
+   intersect removes nothing, so every op repeats the same search */
+static void bench_sorted_with(Bench *b, bool unite, size_t ratio, int side)
+{
+	Slist *longer = NULL, *shorter = NULL;
+	size_t i = 0;
+
+	longer = bench_sorted_list(b, 1, side);
+	shorter = bench_sorted_list(b, ratio, BENCH_WALK);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += unite ? slist_sorted_union(longer, shorter) : slist_sorted_intersect(shorter, longer);
+	bench_stop(b);
+
+	slist_destroy_deep(shorter);
+	slist_destroy_deep(longer);
+
+	return;
+}
+
+static void bench_sorted_intersect(Bench *b)             { bench_sorted_with(b, false, 1, BENCH_WALK);        return; }
+static void bench_sorted_intersect_64(Bench *b)          { bench_sorted_with(b, false, 64, BENCH_WALK);       return; }
+static void bench_sorted_intersect_64_gallop(Bench *b)   { bench_sorted_with(b, false, 64, BENCH_PREFETCH);   return; }
+static void bench_sorted_intersect_4096_gallop(Bench *b) { bench_sorted_with(b, false, 4096, BENCH_PREFETCH); return; }
+static void bench_sorted_union_64(Bench *b)              { bench_sorted_with(b, true, 64, BENCH_WALK);        return; }
+static void bench_sorted_union_64_gallop(Bench *b)       { bench_sorted_with(b, true, 64, BENCH_PREFETCH);    return; }
+
+static void bench_copy_with(Bench *b, bool deep)
+{
+	Slist *list = NULL, **copies = NULL;
+	SlistNode *p = NULL;
+	size_t i = 0;
+
+	list = bench_list(b, BENCH_ORDERED, NULL);
+	copies = (Slist **)bench_check(malloc(b->ops * sizeof(Slist *)));
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		copies[i] = deep ? slist_copy_deep(list) : slist_copy(list);
+	bench_stop(b);
+
+	for (i = 0; i < b->ops; i++) {
+		for (p = slist_first_node(copies[i]); deep && p; p = p->next) free(p->data);
+		slist_destroy_deep(copies[i]);
+	}
+	free(copies);
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_copy_deep_inline(Bench *b)
+{
+	Slist *list = NULL, **copies = NULL;
+	size_t i = 0;
+
+	list = bench_list_inline(b);
+	copies = (Slist **)bench_check(malloc(b->ops * sizeof(Slist *)));
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		copies[i] = slist_copy_deep(list);
+	bench_stop(b);
+
+	bench_lists_destroy(copies, b->ops);
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_copy(Bench *b)
+{
+	bench_copy_with(b, false);
+
+	return;
+}
+
+static void bench_copy_deep(Bench *b)
+{
+	bench_copy_with(b, true);
+
+	return;
+}
+
+#define BENCH_COPY_READ   0  /* the copy is only read */
+#define BENCH_COPY_FIRST  1  /* one prepend, nothing to copy */
+#define BENCH_COPY_MIDDLE 2  /* one insert at n/2, half the nodes are copied */
+#define BENCH_COPY_EAGER  3  /* a prefetch table makes slist_copy_lazy copy every node */
+
+/* slist_copy_lazy shares the nodes until the first edit, what that edit costs */
+static void bench_copy_write_with(Bench *b, int write)
+{
+	Slist *list = NULL, **copies = NULL;
+	size_t i = 0;
+
+	list = bench_list(b, BENCH_ORDERED, NULL);
+	if (write == BENCH_COPY_EAGER) bench_list_side(list, BENCH_PREFETCH);
+	copies = (Slist **)bench_check(malloc(b->ops * sizeof(Slist *)));
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		copies[i] = (Slist *)bench_check(slist_copy_lazy(list));
+		if (write == BENCH_COPY_FIRST && slist_add_data_first(copies[i], &bench_missing) != 0) bench_check(NULL);
+		if (write == BENCH_COPY_MIDDLE && slist_add_data_index(copies[i], b->n / 2, &bench_missing) != 0) bench_check(NULL);
+		bench_sink += (uintptr_t)slist_first_data(copies[i]) + slist_count(copies[i]);
+	}
+	bench_stop(b);
+
+	bench_lists_destroy(copies, b->ops);
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_copy_read(Bench *b)   { bench_copy_write_with(b, BENCH_COPY_READ);   return; }
+static void bench_copy_first(Bench *b)  { bench_copy_write_with(b, BENCH_COPY_FIRST);  return; }
+static void bench_copy_middle(Bench *b) { bench_copy_write_with(b, BENCH_COPY_MIDDLE); return; }
+static void bench_copy_eager(Bench *b)  { bench_copy_write_with(b, BENCH_COPY_EAGER);  return; }
+
+static void bench_clear_with(Bench *b, SlistNodePool *pool)
+{
+	Slist **lists = NULL;
+	size_t i = 0;
+
+	lists = (Slist **)bench_check(malloc(b->ops * sizeof(Slist *)));
+	for (i = 0; i < b->ops; i++) lists[i] = bench_list(b, BENCH_ORDERED, pool);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		slist_clear(lists[i]);
+	bench_stop(b);
+
+	bench_lists_destroy(lists, b->ops);
+
+	return;
+}
+
+/* the chain joins the pool's free list at once */
+static void bench_clear(Bench *b)
+{
+	SlistNodePool *pool = NULL;
+
+	pool = (SlistNodePool *)bench_check(slist_node_pool_create(1024));
+	bench_clear_with(b, pool);
+	slist_node_pool_destroy(pool);
+
+	return;
+}
+
+static void bench_clear_malloc(Bench *b)
+{
+	bench_clear_with(b, NULL);
+
+	return;
+}
+
+static void bench_clear_deep_with(Bench *b, bool batch)
+{
+	Slist **lists = NULL;
+	size_t i = 0;
+
+	lists = (Slist **)bench_check(malloc(b->ops * sizeof(Slist *)));
+	for (i = 0; i < b->ops; i++) {
+		lists[i] = bench_list_owned(b);
+		if (batch) slist_set_data_free_batch(lists[i], bench_data_free_batch);
+	}
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		slist_clear_deep(lists[i]);
+	bench_stop(b);
+
+	bench_lists_destroy(lists, b->ops);
+
+	return;
+}
+
+static void bench_clear_deep(Bench *b)
+{
+	bench_clear_deep_with(b, false);
+
+	return;
+}
+
+static void bench_clear_deep_batch(Bench *b)
+{
+	bench_clear_deep_with(b, true);
+
+	return;
+}
+
+/* time until the caller gets control back, the teardown itself is not timed */
+static void bench_destroy_deep_async(Bench *b)
+{
+	Slist **lists = NULL;
+	size_t i = 0;
+
+	lists = (Slist **)bench_check(malloc(b->ops * sizeof(Slist *)));
+	for (i = 0; i < b->ops; i++) lists[i] = bench_list_owned(b);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		slist_parallel_destroy_deep(lists[i]);
+	bench_stop(b);
+
+	slist_parallel_destroy_wait();
+	free(lists);
+
+	return;
+}
+
+static void bench_concat(Bench *b)
+{
+	Slist **lists1 = NULL, **lists2 = NULL;
+	size_t i = 0;
+
+	lists1 = bench_lists(b, b->ops, BENCH_ORDERED);
+	lists2 = bench_lists(b, b->ops, BENCH_ORDERED);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		slist_concat(lists1[i], lists2[i]);
+	bench_stop(b);
+
+	free(lists2);
+	bench_lists_destroy(lists1, b->ops);
+
+	return;
+}
+
+static void bench_splice(Bench *b)
+{
+	Slist **lists1 = NULL, **lists2 = NULL;
+	size_t i = 0;
+
+	lists1 = bench_lists(b, b->ops, BENCH_ORDERED);
+	lists2 = bench_lists(b, b->ops, BENCH_ORDERED);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		slist_splice(lists1[i], lists2[i]);
+	bench_stop(b);
+
+	bench_lists_destroy(lists2, b->ops);
+	bench_lists_destroy(lists1, b->ops);
+
+	return;
+}
+
+/* split in the middle */
+static void bench_split_with(Bench *b, bool by_node)
+{
+	Slist **lists = NULL, **tails = NULL;
+	SlistNode **middle = NULL;
+	size_t i = 0;
+
+	lists = bench_lists(b, b->ops, BENCH_ORDERED);
+	tails = (Slist **)bench_check(malloc(b->ops * sizeof(Slist *)));
+	middle = (SlistNode **)bench_check(malloc(b->ops * sizeof(SlistNode *)));
+	for (i = 0; by_node && i < b->ops; i++)
+		middle[i] = slist_get_node_by_index(lists[i], (b->n - 1) / 2);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		if (by_node)
+			tails[i] = slist_split_at_node(lists[i], middle[i]);
+		else
+			tails[i] = slist_split_at_index(lists[i], b->n / 2);
+	}
+	bench_stop(b);
+
+	free(middle);
+	bench_lists_destroy(tails, b->ops);
+	bench_lists_destroy(lists, b->ops);
+
+	return;
+}
+
+static void bench_split_at_index(Bench *b)
+{
+	bench_split_with(b, false);
+
+	return;
+}
+
+static void bench_split_at_node(Bench *b)
+{
+	bench_split_with(b, true);
+
+	return;
+}
+
+// scans --- a miss walks every element
+static void bench_scan_with(Bench *b, int order, int side)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = bench_list(b, order, NULL);
+	bench_list_side(list, side);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += (uintptr_t)slist_get_index_by_data(list, &bench_missing);
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_scan_slist(Bench *b)
+{
+	bench_scan_with(b, BENCH_ORDERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_scan_scattered(Bench *b)
+{
+	bench_scan_with(b, BENCH_SCATTERED, BENCH_WALK);
+
+	return;
+}
+
+static void bench_scan_prefetch(Bench *b)
+{
+	bench_scan_with(b, BENCH_SCATTERED, BENCH_PREFETCH);
+
+	return;
+}
+
+/* a scattered pooled list laid out again before the scans */
+static void bench_scan_compacted(Bench *b)
+{
+	SlistNodePool *pool = NULL;
+	Slist *list = NULL;
+	size_t i = 0;
+
+	pool = (SlistNodePool *)bench_check(slist_node_pool_create(1024));
+	list = bench_list(b, BENCH_SCATTERED, pool);
+	if (slist_compact(list, 0) != 0) bench_check(NULL);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += (uintptr_t)slist_get_index_by_data(list, &bench_missing);
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+	slist_node_pool_destroy(pool);
+
+	return;
+}
+
+/* every op lays the whole list out again, in steps of BENCH_BATCH nodes */
+static void bench_compact(Bench *b)
+{
+	SlistNodePool *pool = NULL;
+	Slist *list = NULL;
+	size_t i = 0;
+
+	pool = (SlistNodePool *)bench_check(slist_node_pool_create(1024));
+	list = bench_list(b, BENCH_SCATTERED, pool);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		while (slist_compact(list, BENCH_BATCH) > 0);
+	}
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+	slist_node_pool_destroy(pool);
+
+	return;
+}
+
+static void bench_scan_inline(Bench *b)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = bench_list_inline(b);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += (uintptr_t)slist_get_index_by_data(list, &bench_missing);
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_scan_unrolled(Bench *b)
+{
+	SlistUnrolled *list = NULL;
+	size_t i = 0;
+
+	list = (SlistUnrolled *)bench_check(slist_unrolled_create_full(bench_data_cmp, bench_data_equ, bench_data_copy, NULL));
+	for (i = 0; i < b->n; i++) {
+		if (slist_unrolled_add_data_last(list, BENCH_DATA(i)) != 0) bench_check(NULL);
+	}
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += (uintptr_t)slist_unrolled_get_index_by_data(list, &bench_missing);
+	bench_stop(b);
+
+	slist_unrolled_clear(list);
+	slist_unrolled_destroy(list);
+
+	return;
+}
+
+/* slots hold the keys themselves, the search never leaves the blocks */
+static SlistUnrolled *bench_unrolled_ints(size_t n)
+{
+	SlistUnrolled *list = NULL;
+	size_t i = 0;
+
+	list = (SlistUnrolled *)bench_check(slist_unrolled_create());
+	for (i = 0; i < n; i++) {
+		if (slist_unrolled_add_data_last(list, (void *)(intptr_t)i) != 0) bench_check(NULL);
+	}
+
+	return list;
+}
+
+static void bench_unrolled_get_index_by_int(Bench *b)
+{
+	SlistUnrolled *list = NULL;
+	size_t i = 0;
+
+	list = bench_unrolled_ints(b->n);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += (uintptr_t)slist_unrolled_get_index_by_int(list, -1);
+	bench_stop(b);
+
+	slist_unrolled_clear(list);
+	slist_unrolled_destroy(list);
+
+	return;
+}
+
+static void bench_unrolled_count_int(Bench *b)
+{
+	SlistUnrolled *list = NULL;
+	size_t i = 0;
+
+	list = bench_unrolled_ints(b->n);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += slist_unrolled_count_int(list, (int64_t)(i % b->n));
+	bench_stop(b);
+
+	slist_unrolled_clear(list);
+	slist_unrolled_destroy(list);
+
+	return;
+}
+
+static void bench_unrolled_get_data_by_index(Bench *b)
+{
+	SlistUnrolled *list = NULL;
+	size_t i = 0, *pos = NULL;
+
+	list = (SlistUnrolled *)bench_check(slist_unrolled_create_full(bench_data_cmp, bench_data_equ, bench_data_copy, NULL));
+	for (i = 0; i < b->n; i++) {
+		if (slist_unrolled_add_data_last(list, BENCH_DATA(i)) != 0) bench_check(NULL);
+	}
+	pos = (size_t *)bench_check(malloc(b->ops * sizeof(size_t)));
+	for (i = 0; i < b->ops; i++) pos[i] = bench_rand_below(b, b->n);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += (uintptr_t)slist_unrolled_get_data_by_index(list, pos[i]);
+	bench_stop(b);
+
+	free(pos);
+	slist_unrolled_clear(list);
+	slist_unrolled_destroy(list);
+
+	return;
+}
+
+// snapshot --- startup from a file instead of n appends, files live on tmpfs
+static void bench_snapshot_file(Bench *b, char *path)
+{
+	Slist *list = NULL;
+	int fd = -1;
+
+	fd = mkstemp(path);
+	if (fd < 0) bench_check(NULL);
+	close(fd);
+
+	list = bench_list_inline(b);
+	if (slist_snapshot_write(list, path, 0) != 0) bench_check(NULL);
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_snapshot_write(Bench *b)
+{
+	char path[] = "/dev/shm/slist_bench_XXXXXX";
+	Slist *list = NULL;
+	size_t i = 0;
+
+	bench_snapshot_file(b, path);
+	list = bench_list_inline(b);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		if (slist_snapshot_write(list, path, 0) != 0) bench_check(NULL);
+	}
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+	unlink(path);
+
+	return;
+}
+
+/* every op gets the whole list back and reads every element once */
+static void bench_startup_rebuild(Bench *b)
+{
+	Slist *list = NULL;
+	SlistNode *p = NULL;
+	size_t i = 0, j = 0;
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		list = (Slist *)bench_check(slist_create_inline(sizeof(long), bench_data_cmp, bench_data_equ, NULL));
+		for (j = 0; j < b->n; j++) {
+			if (slist_add_data_last(list, BENCH_DATA(j)) != 0) bench_check(NULL);
+		}
+		for (p = slist_first_node(list); p; p = p->next) 
+			bench_sink += *(long *)p->data;
+		slist_destroy_deep(list);
+	}
+	bench_stop(b);
+
+	return;
+}
+
+static void bench_startup_mapped(Bench *b)
+{
+	char path[] = "/dev/shm/slist_bench_XXXXXX";
+	Slist *list = NULL;
+	size_t i = 0, j = 0;
+
+	bench_snapshot_file(b, path);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		list = (Slist *)bench_check(slist_snapshot_map(path, bench_data_cmp, bench_data_equ));
+		for (j = 0; j < b->n; j++) 
+			bench_sink += *(long *)slist_get_data_by_index(list, j);
+		slist_destroy(list);
+	}
+	bench_stop(b);
+
+	unlink(path);
+
+	return;
+}
+
+static void bench_scan_mapped(Bench *b)
+{
+	char path[] = "/dev/shm/slist_bench_XXXXXX";
+	Slist *list = NULL;
+	size_t i = 0;
+
+	bench_snapshot_file(b, path);
+	list = (Slist *)bench_check(slist_snapshot_map(path, bench_data_cmp, bench_data_equ));
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += (uintptr_t)slist_get_index_by_data(list, &bench_missing);
+	bench_stop(b);
+
+	slist_destroy(list);
+	unlink(path);
+
+	return;
+}
+
+// persistent --- versions share every node behind the first
+static SlistPersistent *bench_persistent(Bench *b)
+{
+	SlistPersistent *version = NULL, *next = NULL;
+	size_t i = 0;
+
+	version = (SlistPersistent *)bench_check(slist_persistent_create(bench_data_equ, NULL));
+	for (i = b->n; i > 0; i--) {
+		next = (SlistPersistent *)bench_check(slist_persistent_add_data_first(version, BENCH_DATA(i - 1)));
+		slist_persistent_release(version);
+		version = next;
+	}
+
+	return version;
+}
+
+static void bench_persistent_add_data_first(Bench *b)
+{
+	SlistPersistent *version = NULL, *next = NULL;
+	size_t i = 0;
+
+	version = bench_persistent(b);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		next = slist_persistent_add_data_first(version, &bench_missing);
+		slist_persistent_release(version);
+		version = next;
+	}
+	bench_stop(b);
+
+	slist_persistent_release(version);
+
+	return;
+}
+
+static void bench_persistent_remove_data_first(Bench *b)
+{
+	SlistPersistent *version = NULL, *next = NULL;
+	void *data = NULL;
+	size_t i = 0;
+
+	/* ops data in front of the n, so every pop leaves an n list behind */
+	version = bench_persistent(b);
+	for (i = 0; i < b->ops; i++) {
+		next = (SlistPersistent *)bench_check(slist_persistent_add_data_first(version, &bench_missing));
+		slist_persistent_release(version);
+		version = next;
+	}
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		slist_persistent_remove_data_first(version, &next, &data);
+		slist_persistent_release(version);
+		version = next;
+	}
+	bench_stop(b);
+
+	slist_persistent_release(version);
+
+	return;
+}
+
+/* compare with slist_copy, the other way to keep a list as it is now */
+static void bench_snapshot_persistent(Bench *b)
+{
+	SlistPersistent *version = NULL, **snapshots = NULL;
+	size_t i = 0;
+
+	version = bench_persistent(b);
+	snapshots = (SlistPersistent **)bench_check(malloc(b->ops * sizeof(SlistPersistent *)));
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		snapshots[i] = slist_persistent_retain(version);
+	bench_stop(b);
+
+	for (i = 0; i < b->ops; i++)
+		slist_persistent_release(snapshots[i]);
+	free(snapshots);
+	slist_persistent_release(version);
+
+	return;
+}
+
+static void bench_scan_persistent(Bench *b)
+{
+	SlistPersistent *version = NULL;
+	size_t i = 0;
+
+	version = bench_persistent(b);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += (uintptr_t)slist_persistent_get_index_by_data(version, &bench_missing);
+	bench_stop(b);
+
+	slist_persistent_release(version);
+
+	return;
+}
+
+// priority queue --- n pending, every op takes the smallest and adds one
+static void bench_pq_sorted_list(Bench *b)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = bench_list(b, BENCH_ORDERED, NULL);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		bench_sink += (uintptr_t)remove_data_by_index(list, 0);
+		slist_add_data_sorted(list, BENCH_DATA(bench_rand_below(b, b->n)));
+	}
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static SlistHeap *bench_heap(Bench *b, SlistHeapNode **nodes)
+{
+	SlistHeap *heap = NULL;
+	SlistHeapNode *node = NULL;
+	size_t i = 0;
+
+	heap = (SlistHeap *)bench_check(slist_heap_create(bench_data_cmp, NULL));
+	for (i = 0; i < b->n; i++) {
+		node = (SlistHeapNode *)bench_check(slist_heap_insert(heap, BENCH_DATA(bench_rand_below(b, b->n))));
+		if (nodes) nodes[i] = node;
+	}
+
+	return heap;
+}
+
+static void bench_pq_heap(Bench *b)
+{
+	SlistHeap *heap = NULL;
+	size_t i = 0;
+
+	heap = bench_heap(b, NULL);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		bench_sink += (uintptr_t)slist_heap_remove_min(heap);
+		slist_heap_insert(heap, BENCH_DATA(bench_rand_below(b, b->n)));
+	}
+	bench_stop(b);
+
+	slist_heap_destroy_deep(heap);
+
+	return;
+}
+
+/* keys halve until they reach 0, a key of 0 is decreased to itself */
+static void bench_heap_decrease_key(Bench *b)
+{
+	SlistHeap *heap = NULL;
+	SlistHeapNode **nodes = NULL;
+	size_t i = 0, j = 0, *pos = NULL;
+
+	nodes = (SlistHeapNode **)bench_check(malloc(b->n * sizeof(SlistHeapNode *)));
+	heap = bench_heap(b, nodes);
+	pos = (size_t *)bench_check(malloc(b->ops * sizeof(size_t)));
+	for (i = 0; i < b->ops; i++) pos[i] = bench_rand_below(b, b->n);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		j = pos[i];
+		slist_heap_decrease_key(heap, nodes[j], BENCH_DATA(*(long *)slist_heap_node_data(nodes[j]) / 2));
+	}
+	bench_stop(b);
+
+	free(pos);
+	slist_heap_destroy_deep(heap);
+	free(nodes);
+
+	return;
+}
+
+// typed --- data by value, comparisons inlined
+static bench_typed *bench_typed_list(Bench *b, int order)
+{
+	bench_typed *list = NULL;
+	size_t *perm = NULL, i = 0;
+
+	list = (bench_typed *)bench_check(bench_typed_create());
+
+	if (order == BENCH_SHUFFLED) perm = bench_perm(b, b->n);
+	for (i = 0; i < b->n; i++) {
+		if (bench_typed_add_data_last(list, (long)(perm ? perm[i] : i)) != 0)
+			bench_check(NULL);
+	}
+	free(perm);
+
+	return list;
+}
+
+static void bench_scan_typed(Bench *b)
+{
+	bench_typed *list = NULL;
+	size_t i = 0;
+
+	list = bench_typed_list(b, BENCH_ORDERED);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += (uintptr_t)bench_typed_get_index_by_data(list, bench_missing);
+	bench_stop(b);
+
+	bench_typed_destroy(list);
+
+	return;
+}
+
+static void bench_sort_typed(Bench *b)
+{
+	bench_typed **lists = NULL;
+	size_t i = 0;
+
+	lists = (bench_typed **)bench_check(malloc(b->ops * sizeof(bench_typed *)));
+	for (i = 0; i < b->ops; i++) lists[i] = bench_typed_list(b, BENCH_SHUFFLED);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_typed_sort(lists[i]);
+	bench_stop(b);
+
+	for (i = 0; i < b->ops; i++) bench_typed_destroy(lists[i]);
+	free(lists);
+
+	return;
+}
+
+// parallel --- cpu heavy callbacks, every online cpu
+static void bench_visit_heavy(void *data, void *user_data)
+{
+	atomic_fetch_add_explicit((atomic_uintptr_t *)user_data, bench_heavy(data), memory_order_relaxed);
+
+	return;
+}
+
+static int bench_find_heavy(void *data, void *user_data)
+{
+	(void)user_data;
+
+	return (bench_heavy(data) & 1) ? 1 : 0;
+}
+
+static void *bench_reduce_heavy(void *acc, void *data, void *user_data)
+{
+	(void)user_data;
+
+	return (void *)((uintptr_t)acc + bench_heavy(data));
+}
+
+static void *bench_combine(void *acc1, void *acc2, void *user_data)
+{
+	(void)user_data;
+
+	return (void *)((uintptr_t)acc1 + (uintptr_t)acc2);
+}
+
+/* the serial baseline for the parallel cases */
+static void bench_for_each_serial(Bench *b)
+{
+	Slist *list = NULL;
+	SlistNode *p = NULL;
+	uintptr_t sum = 0;
+	size_t i = 0;
+
+	list = bench_list(b, BENCH_ORDERED, NULL);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		for (p = slist_first_node(list); p; p = p->next)
+			sum += bench_heavy(p->data);
+	}
+	bench_stop(b);
+
+	bench_sink += sum;
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_parallel_for_each(Bench *b)
+{
+	Slist *list = NULL;
+	atomic_uintptr_t sum;
+	size_t i = 0;
+
+	list = bench_list(b, BENCH_ORDERED, NULL);
+	atomic_init(&sum, 0);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		slist_parallel_for_each(list, bench_visit_heavy, &sum, 0);
+	bench_stop(b);
+
+	bench_sink += atomic_load(&sum);
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_parallel_count_if(Bench *b)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = bench_list(b, BENCH_ORDERED, NULL);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += slist_parallel_count_if(list, bench_find_heavy, NULL, 0);
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+
+	return;
+}
+
+static void bench_parallel_filter(Bench *b)
+{
+	Slist **lists = NULL;
+	size_t i = 0;
+
+	lists = bench_lists(b, b->ops, BENCH_ORDERED);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += slist_parallel_filter(lists[i], bench_find_heavy, NULL, 0);
+	bench_stop(b);
+
+	bench_lists_destroy(lists, b->ops);
+
+	return;
+}
+
+static void bench_parallel_reduce(Bench *b)
+{
+	Slist *list = NULL;
+	size_t i = 0;
+
+	list = bench_list(b, BENCH_ORDERED, NULL);
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++)
+		bench_sink += (uintptr_t)slist_parallel_reduce(list, bench_reduce_heavy, bench_combine, NULL, 0);
+	bench_stop(b);
+
+	slist_destroy_deep(list);
+
+	return;
+}
+
+// threads --- half of b->threads produce, the other half consume
+typedef struct BenchQueue {
+	SlistConcurrent *lockfree;
+	Slist *list;                 /* mutex baseline when lockfree is NULL */
+	pthread_mutex_t lock;
+	size_t items;                /* per producer */
+	atomic_size_t left;          /* items the consumers still have to take */
+} BenchQueue;
+
+static void *bench_queue_producer(void *arg)
+{
+	BenchQueue *queue = (BenchQueue *)arg;
+	size_t i = 0;
+
+	for (i = 0; i < queue->items; i++) {
+		if (queue->lockfree) {
+			slist_concurrent_add_data_last(queue->lockfree, &bench_missing);
+		} else {
+			pthread_mutex_lock(&queue->lock);
+			slist_add_data_last(queue->list, &bench_missing);
+			pthread_mutex_unlock(&queue->lock);
+		}
+	}
+
+	return NULL;
+}
+
+static void *bench_queue_consumer(void *arg)
+{
+	BenchQueue *queue = (BenchQueue *)arg;
+	void *data = NULL;
+
+	while (atomic_load_explicit(&queue->left, memory_order_relaxed) > 0) {
+		if (queue->lockfree) {
+			data = slist_concurrent_remove_data_first(queue->lockfree);
+		} else {
+			pthread_mutex_lock(&queue->lock);
+			data = slist_isempty(queue->list) ? NULL : remove_data_by_index(queue->list, 0);
+			pthread_mutex_unlock(&queue->lock);
+		}
+		if (data) atomic_fetch_sub_explicit(&queue->left, 1, memory_order_relaxed);
+	}
+
+	return NULL;
+}
+
+static void bench_queue_with(Bench *b, bool lockfree)
+{
+	BenchQueue queue;
+	pthread_t *threads = NULL;
+	int producers = 0, t = 0;
+
+	queue.lockfree = NULL;
+	queue.list = NULL;
+	if (lockfree)
+		queue.lockfree = (SlistConcurrent *)bench_check(slist_concurrent_create(NULL));
+	else
+		queue.list = (Slist *)bench_check(slist_create());
+	pthread_mutex_init(&queue.lock, NULL);
+	producers = b->threads / 2;
+	queue.items = b->ops / (size_t)producers;
+	atomic_init(&queue.left, queue.items * (size_t)producers);
+	b->ops = queue.items * (size_t)producers;
+
+	threads = (pthread_t *)bench_check(malloc(2 * (size_t)producers * sizeof(pthread_t)));
+
+	bench_start(b);
+	for (t = 0; t < producers; t++) {
+		if (pthread_create(&threads[2 * t], NULL, bench_queue_producer, &queue) != 0) bench_check(NULL);
+		if (pthread_create(&threads[2 * t + 1], NULL, bench_queue_consumer, &queue) != 0) bench_check(NULL);
+	}
+	for (t = 0; t < 2 * producers; t++)
+		pthread_join(threads[t], NULL);
+	bench_stop(b);
+
+	free(threads);
+	pthread_mutex_destroy(&queue.lock);
+	if (lockfree)
+		slist_concurrent_destroy(queue.lockfree);
+	else
+		slist_destroy_deep(queue.list);
+
+	return;
+}
+
+static void bench_queue_lockfree(Bench *b)
+{
+	bench_queue_with(b, true);
+
+	return;
+}
+
+static void bench_queue_mutex(Bench *b)
+{
+	bench_queue_with(b, false);
+
+	return;
+}
+
+// threads --- b->threads / 2 producer and consumer pairs, every pair has its
+// own ring and is pinned to two cpus of its own where there are enough
+#define BENCH_RING_SLOTS 1024
+#define BENCH_RING_BATCH 64
+
+typedef struct BenchRing {
+	SlistRing *ring;
+	size_t items;
+	bool batch;
+	int cpu;                     /* producer's, the consumer takes the next one */
+} BenchRing;
+
+static void bench_pin(int cpu)
+{
+	cpu_set_t set;
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu % (cpus > 0 ? cpus : 1), &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set); /* unpinned if refused */
+
+	return;
+}
+
+static void *bench_ring_producer(void *arg)
+{
+	BenchRing *pair = (BenchRing *)arg;
+	void *data[BENCH_RING_BATCH];
+	size_t i = 0, n = 0;
+
+	bench_pin(pair->cpu);
+	for (i = 0; i < BENCH_RING_BATCH; i++) data[i] = &bench_missing;
+
+	for (i = 0; i < pair->items; i += n) {
+		if (pair->batch) {
+			n = pair->items - i < BENCH_RING_BATCH ? pair->items - i : BENCH_RING_BATCH;
+			n = slist_ring_add_data_last_batch(pair->ring, data, n);
+		} else {
+			n = slist_ring_add_data_last(pair->ring, &bench_missing) == 0;
+		}
+		if (n == 0) sched_yield(); /* full, the consumer may share this cpu */
+	}
+
+	return NULL;
+}
+
+static void *bench_ring_consumer(void *arg)
+{
+	BenchRing *pair = (BenchRing *)arg;
+	void *data[BENCH_RING_BATCH];
+	uintptr_t sink = 0;
+	size_t i = 0, n = 0;
+
+	bench_pin(pair->cpu + 1);
+
+	for (i = 0; i < pair->items; i += n) {
+		if (pair->batch) {
+			n = slist_ring_remove_data_first_batch(pair->ring, data, BENCH_RING_BATCH);
+			if (n > 0) sink += (uintptr_t)data[n - 1];
+		} else {
+			data[0] = slist_ring_remove_data_first(pair->ring);
+			n = data[0] != NULL;
+			sink += (uintptr_t)data[0];
+		}
+		if (n == 0) sched_yield();
+	}
+	bench_sink += sink;
+
+	return NULL;
+}
+
+static void bench_ring_with(Bench *b, bool batch)
+{
+	BenchRing *pairs = NULL;
+	pthread_t *threads = NULL;
+	size_t items = 0;
+	int count = 0, t = 0;
+
+	count = b->threads / 2;
+	items = b->ops / (size_t)count;
+	pairs = (BenchRing *)bench_check(malloc((size_t)count * sizeof(BenchRing)));
+	threads = (pthread_t *)bench_check(malloc(2 * (size_t)count * sizeof(pthread_t)));
+	for (t = 0; t < count; t++) {
+		pairs[t].ring = (SlistRing *)bench_check(slist_ring_create(BENCH_RING_SLOTS, NULL));
+		pairs[t].items = items;
+		pairs[t].batch = batch;
+		pairs[t].cpu = 2 * t;
+	}
+	b->ops = items * (size_t)count;
+
+	bench_start(b);
+	for (t = 0; t < count; t++) {
+		if (pthread_create(&threads[2 * t], NULL, bench_ring_producer, &pairs[t]) != 0) bench_check(NULL);
+		if (pthread_create(&threads[2 * t + 1], NULL, bench_ring_consumer, &pairs[t]) != 0) bench_check(NULL);
+	}
+	for (t = 0; t < 2 * count; t++)
+		pthread_join(threads[t], NULL);
+	bench_stop(b);
+
+	for (t = 0; t < count; t++) slist_ring_destroy(pairs[t].ring);
+	free(threads);
+	free(pairs);
+
+	return;
+}
+
+static void bench_ring_spsc(Bench *b)
+{
+	bench_ring_with(b, false);
+
+	return;
+}
+
+static void bench_ring_spsc_batch(Bench *b)
+{
+	bench_ring_with(b, true);
+
+	return;
+}
+
+// threads --- one writer replaces the first data, the other threads scan
+#define BENCH_READERS_LEN 1000   /* elements every reader walks */
+
+typedef struct BenchReaders {
+	SlistPersistent *current;    /* mutex baseline when NULL */
+	Slist *list;
+	pthread_mutex_t lock;        /* guards current, or the whole list */
+	atomic_bool done;
+	atomic_size_t scans;
+} BenchReaders;
+
+static void *bench_readers_reader(void *arg)
+{
+	BenchReaders *readers = (BenchReaders *)arg;
+	SlistPersistent *version = NULL;
+	uintptr_t sink = 0;
+	size_t scans = 0;
+
+	while (!atomic_load_explicit(&readers->done, memory_order_relaxed)) {
+		if (readers->current) {
+			/* the lock only covers taking a hold, the scan runs unlocked */
+			pthread_mutex_lock(&readers->lock);
+			version = slist_persistent_retain(readers->current);
+			pthread_mutex_unlock(&readers->lock);
+			sink += (uintptr_t)slist_persistent_get_index_by_data(version, &bench_missing);
+			slist_persistent_release(version);
+		} else {
+			pthread_mutex_lock(&readers->lock);
+			sink += (uintptr_t)slist_get_index_by_data(readers->list, &bench_missing);
+			pthread_mutex_unlock(&readers->lock);
+		}
+		scans++;
+	}
+	atomic_fetch_add_explicit(&readers->scans, scans, memory_order_relaxed);
+	bench_sink += sink;
+
+	return NULL;
+}
+
+static void bench_readers_with(Bench *b, bool persistent)
+{
+	BenchReaders readers;
+	SlistPersistent *old = NULL, *next = NULL;
+	pthread_t *threads = NULL;
+	void *data = NULL;
+	size_t i = 0;
+	int t = 0;
+
+	readers.current = NULL;
+	readers.list = NULL;
+	if (persistent) {
+		readers.current = (SlistPersistent *)bench_check(slist_persistent_create(bench_data_equ, NULL));
+		for (i = 0; i < BENCH_READERS_LEN; i++) {
+			next = (SlistPersistent *)bench_check(slist_persistent_add_data_first(readers.current, &bench_filler));
+			slist_persistent_release(readers.current);
+			readers.current = next;
+		}
+	} else {
+		readers.list = (Slist *)bench_check(slist_create_pool(bench_data_cmp, bench_data_equ, NULL, NULL, NULL));
+		for (i = 0; i < BENCH_READERS_LEN; i++) {
+			if (slist_add_data_first(readers.list, &bench_filler) != 0)
+				bench_check(NULL);
+		}
+	}
+	pthread_mutex_init(&readers.lock, NULL);
+	atomic_init(&readers.done, false);
+	atomic_init(&readers.scans, 0);
+
+	threads = (pthread_t *)bench_check(malloc((size_t)(b->threads - 1) * sizeof(pthread_t)));
+	for (t = 0; t < b->threads - 1; t++) {
+		if (pthread_create(&threads[t], NULL, bench_readers_reader, &readers) != 0) bench_check(NULL);
+	}
+
+	bench_start(b);
+	for (i = 0; i < b->ops; i++) {
+		if (persistent) {
+			old = readers.current;
+			if (slist_persistent_remove_data_first(old, &next, &data) != 0) bench_check(NULL);
+			old = next;
+			next = (SlistPersistent *)bench_check(slist_persistent_add_data_first(old, data));
+			slist_persistent_release(old);
+			pthread_mutex_lock(&readers.lock);
+			old = readers.current;
+			readers.current = next;
+			pthread_mutex_unlock(&readers.lock);
+			slist_persistent_release(old);
+		} else {
+			pthread_mutex_lock(&readers.lock);
+			data = remove_data_by_index(readers.list, 0);
+			slist_add_data_first(readers.list, data);
+			pthread_mutex_unlock(&readers.lock);
+		}
+	}
+	bench_stop(b);
+
+	atomic_store_explicit(&readers.done, true, memory_order_relaxed);
+	for (t = 0; t < b->threads - 1; t++)
+		pthread_join(threads[t], NULL);
+
+	free(threads);
+	pthread_mutex_destroy(&readers.lock);
+	if (persistent)
+		slist_persistent_release(readers.current);
+	else
+		slist_destroy_deep(readers.list);
+
+	return;
+}
+
+static void bench_readers_persistent(Bench *b)
+{
+	bench_readers_with(b, true);
+
+	return;
+}
+
+static void bench_readers_mutex(Bench *b)
+{
+	bench_readers_with(b, false);
+
+	return;
+}
+
+static const BenchCase bench_cases[] = {
+	{ "slist_add_data_first",                 bench_add_data_first,               BENCH_CONST   },
+	{ "slist_add_data_last",                  bench_add_data_last,                BENCH_CONST   },
+	{ "slist_add_data_last/pool",             bench_add_data_last_pool,           BENCH_CONST   },
+	{ "slist_add_data_last_batch",            bench_add_data_last_batch,          BENCH_CONST   },
+	{ "slist_add_data_last_batch/pool",       bench_add_data_last_batch_pool,     BENCH_CONST   },
+	{ "slist_add_data_index",                 bench_add_data_index,               BENCH_LINEAR  },
+	{ "slist_add_data_index/index",           bench_add_data_index_indexed,       BENCH_CONST   },
+	{ "slist_add_data_prev_node",             bench_add_data_prev_node,           BENCH_LINEAR  },
+	{ "slist_add_data_next_node_safe",        bench_add_data_next_node_safe,      BENCH_LINEAR  },
+	{ "slist_add_data_next_node_unsafe",      bench_add_data_next_node_unsafe,    BENCH_CONST   },
+	{ "slist_add_data_sorted",                bench_add_data_sorted,              BENCH_LINEAR  },
+	{ "slist_add_data_sorted/index",          bench_add_data_sorted_indexed,      BENCH_CONST   },
+	{ "slist_add_node_first",                 bench_add_node_first,               BENCH_LINEAR  },
+	{ "slist_add_node_last",                  bench_add_node_last,                BENCH_LINEAR  },
+	{ "slist_add_node_prev_node",             bench_add_node_prev_node,           BENCH_LINEAR  },
+	{ "slist_add_node_next_node",             bench_add_node_next_node,           BENCH_LINEAR  },
+	{ "slist_add_node_next_node_unsafe",      bench_add_node_next_node_unsafe,    BENCH_LINEAR  },
+	{ "slist_add_node_sorted",                bench_add_node_sorted,              BENCH_LINEAR  },
+	{ "remove_one_by_data",                   bench_remove_one_by_data,           BENCH_LINEAR  },
+	{ "remove_one_by_data/hash",              bench_remove_one_by_data_hashed,    BENCH_CONST   },
+	{ "remove_all_by_data",                   bench_remove_all_by_data,           BENCH_LINEAR  },
+	{ "remove_all_by_data/scattered",         bench_remove_all_by_data_scattered, BENCH_LINEAR  },
+	{ "remove_all_by_data/prefetch",          bench_remove_all_by_data_prefetch,  BENCH_LINEAR  },
+	{ "remove_by_node",                       bench_remove_by_node,               BENCH_LINEAR  },
+	{ "remove_node_by_index",                 bench_remove_node_by_index,         BENCH_LINEAR  },
+	{ "remove_node_by_index/index",           bench_remove_node_by_index_indexed, BENCH_CONST   },
+	{ "remove_data_by_index",                 bench_remove_data_by_index,         BENCH_LINEAR  },
+	{ "remove_data_by_index/index",           bench_remove_data_by_index_indexed, BENCH_CONST   },
+	{ "remove_data_by_index/first",           bench_remove_data_by_index_first,   BENCH_CONST   },
+	{ "remove_data_first_batch",              bench_remove_data_first_batch,      BENCH_CONST   },
+	{ "remove_data_by_index_batch",           bench_remove_data_by_index_batch,   BENCH_LINEAR  },
+	{ "queue_churn",                          bench_queue_churn,                  BENCH_CONST   },
+	{ "queue_churn/pool",                     bench_queue_churn_pool,             BENCH_CONST   },
+	{ "slist_get_node_by_index",              bench_get_node_by_index,            BENCH_LINEAR  },
+	{ "slist_get_node_by_index/index",        bench_get_node_by_index_indexed,    BENCH_CONST   },
+	{ "slist_get_data_by_index",              bench_get_data_by_index,            BENCH_LINEAR  },
+	{ "slist_get_data_by_index/index",        bench_get_data_by_index_indexed,    BENCH_CONST   },
+	{ "slist_get_node_by_data",               bench_get_node_by_data,             BENCH_LINEAR  },
+	{ "slist_get_node_by_data/hash",          bench_get_node_by_data_hashed,      BENCH_CONST   },
+	{ "slist_get_node_by_data/scattered",     bench_get_node_by_data_scattered,   BENCH_LINEAR  },
+	{ "slist_get_node_by_data/prefetch",      bench_get_node_by_data_prefetch,    BENCH_LINEAR  },
+	{ "slist_get_index_by_data",              bench_get_index_by_data,            BENCH_LINEAR  },
+	{ "slist_get_index_by_node",              bench_get_index_by_node,            BENCH_LINEAR  },
+	{ "slist_get_index_by_node/scattered",    bench_get_index_by_node_scattered,  BENCH_LINEAR  },
+	{ "slist_get_index_by_node/prefetch",     bench_get_index_by_node_prefetch,   BENCH_LINEAR  },
+	{ "slist_get_node_custom",                bench_get_node_custom,              BENCH_LINEAR  },
+	{ "slist_first_node",                     bench_first_node,                   BENCH_CONST   },
+	{ "slist_first_data",                     bench_first_data,                   BENCH_CONST   },
+	{ "slist_last_node",                      bench_last_node,                    BENCH_CONST   },
+	{ "slist_last_data",                      bench_last_data,                    BENCH_CONST   },
+	{ "slist_count",                          bench_count,                        BENCH_CONST   },
+	{ "slist_isempty",                        bench_isempty,                      BENCH_CONST   },
+	{ "slist_cursor_next",                    bench_cursor_next,                  BENCH_CONST   },
+	{ "slist_cursor_insert_after",            bench_cursor_insert_after,          BENCH_CONST   },
+	{ "slist_cursor_remove",                  bench_cursor_remove,                BENCH_CONST   },
+	{ "filter/cursor",                        bench_filter_cursor,                BENCH_LINEAR  },
+	{ "slist_reverse",                        bench_reverse,                      BENCH_LINEAR  },
+	{ "slist_reverse/scattered",              bench_reverse_scattered,            BENCH_LINEAR  },
+	{ "slist_reverse/prefetch",               bench_reverse_prefetch,             BENCH_LINEAR  },
+	{ "slist_sort",                           bench_sort,                         BENCH_LINEAR  },
+	{ "slist_sort/qsort",                     bench_sort_qsort,                   BENCH_LINEAR  },
+	{ "slist_sort/typed",                     bench_sort_typed,                   BENCH_LINEAR  },
+	{ "slist_sort_merge",                     bench_sort_merge,                   BENCH_LINEAR  },
+	{ "slist_sorted_intersect",               bench_sorted_intersect,             BENCH_LINEAR  },
+	{ "slist_sorted_intersect/1:64",          bench_sorted_intersect_64,          BENCH_LINEAR  },
+	{ "slist_sorted_intersect/1:64/gallop",   bench_sorted_intersect_64_gallop,   BENCH_LINEAR  },
+	{ "slist_sorted_intersect/1:4096/gallop", bench_sorted_intersect_4096_gallop, BENCH_LINEAR  },
+	{ "slist_sorted_union/64:1",              bench_sorted_union_64,              BENCH_LINEAR  },
+	{ "slist_sorted_union/64:1/gallop",       bench_sorted_union_64_gallop,       BENCH_LINEAR  },
+	{ "slist_copy",                           bench_copy,                         BENCH_LINEAR  },
+	{ "slist_copy_lazy/read",                 bench_copy_read,                    BENCH_LINEAR  },
+	{ "slist_copy_lazy/write_first",          bench_copy_first,                   BENCH_LINEAR  },
+	{ "slist_copy_lazy/write_middle",         bench_copy_middle,                  BENCH_LINEAR  },
+	{ "slist_copy_lazy/eager",                bench_copy_eager,                   BENCH_LINEAR  },
+	{ "slist_copy_deep",                      bench_copy_deep,                    BENCH_LINEAR  },
+	{ "slist_copy_deep/inline",               bench_copy_deep_inline,             BENCH_LINEAR  },
+	{ "slist_clear",                          bench_clear,                        BENCH_LINEAR  },
+	{ "slist_clear/malloc",                   bench_clear_malloc,                 BENCH_LINEAR  },
+	{ "slist_clear_deep",                     bench_clear_deep,                   BENCH_LINEAR  },
+	{ "slist_clear_deep/batch",               bench_clear_deep_batch,             BENCH_LINEAR  },
+	{ "slist_destroy_deep/async",             bench_destroy_deep_async,           BENCH_LINEAR  },
+	{ "slist_concat",                         bench_concat,                       BENCH_LINEAR  },
+	{ "slist_splice",                         bench_splice,                       BENCH_LINEAR  },
+	{ "slist_split_at_index",                 bench_split_at_index,               BENCH_LINEAR  },
+	{ "slist_split_at_node",                  bench_split_at_node,                BENCH_LINEAR  },
+	{ "scan/slist",                           bench_scan_slist,                   BENCH_LINEAR  },
+	{ "scan/scattered",                       bench_scan_scattered,               BENCH_LINEAR  },
+	{ "scan/prefetch",                        bench_scan_prefetch,                BENCH_LINEAR  },
+	{ "scan/compacted",                       bench_scan_compacted,               BENCH_LINEAR  },
+	{ "slist_compact",                        bench_compact,                      BENCH_LINEAR  },
+	{ "scan/inline",                          bench_scan_inline,                  BENCH_LINEAR  },
+	{ "scan/unrolled",                        bench_scan_unrolled,                BENCH_LINEAR  },
+	{ "slist_unrolled_get_index_by_int",      bench_unrolled_get_index_by_int,    BENCH_LINEAR  },
+	{ "slist_unrolled_count_int",             bench_unrolled_count_int,           BENCH_LINEAR  },
+	{ "scan/typed",                           bench_scan_typed,                   BENCH_LINEAR  },
+	{ "scan/mapped",                          bench_scan_mapped,                  BENCH_LINEAR  },
+	{ "slist_snapshot_write",                 bench_snapshot_write,               BENCH_LINEAR  },
+	{ "startup/rebuild",                      bench_startup_rebuild,              BENCH_LINEAR  },
+	{ "startup/mapped",                       bench_startup_mapped,               BENCH_LINEAR  },
+	{ "slist_persistent_add_data_first",      bench_persistent_add_data_first,    BENCH_CONST   },
+	{ "slist_persistent_remove_data_first",   bench_persistent_remove_data_first, BENCH_CONST   },
+	{ "snapshot/persistent",                  bench_snapshot_persistent,          BENCH_CONST   },
+	{ "scan/persistent",                      bench_scan_persistent,              BENCH_LINEAR  },
+	{ "pq/sorted_list",                       bench_pq_sorted_list,               BENCH_LINEAR  },
+	{ "pq/heap",                              bench_pq_heap,                      BENCH_CONST   },
+	{ "slist_heap_decrease_key",              bench_heap_decrease_key,            BENCH_CONST   },
+	{ "slist_unrolled_get_data_by_index",     bench_unrolled_get_data_by_index,   BENCH_LINEAR  },
+	{ "for_each/serial",                      bench_for_each_serial,              BENCH_LINEAR  },
+	{ "slist_parallel_for_each",              bench_parallel_for_each,            BENCH_LINEAR  },
+	{ "slist_parallel_count_if",              bench_parallel_count_if,            BENCH_LINEAR  },
+	{ "slist_parallel_filter",                bench_parallel_filter,              BENCH_LINEAR  },
+	{ "slist_parallel_reduce",                bench_parallel_reduce,              BENCH_LINEAR  },
+	{ "slist_concurrent/mpmc",                bench_queue_lockfree,               BENCH_THREADS },
+	{ "mutex/mpmc",                           bench_queue_mutex,                  BENCH_THREADS },
+	{ "slist_ring/spsc",                      bench_ring_spsc,                    BENCH_THREADS },
+	{ "slist_ring/spsc_batch",                bench_ring_spsc_batch,              BENCH_THREADS },
+	{ "slist_persistent/readers",             bench_readers_persistent,           BENCH_THREADS },
+	{ "mutex/readers",                        bench_readers_mutex,                BENCH_THREADS },
+};
+
+// driver
+static void bench_print_per_op(const char *key, bool valid, double value, size_t ops, bool last)
+{
+	if (valid)
+		printf("\"%s\": %.4f%s", key, value / (double)ops, last ? "" : ", ");
+	else
+		printf("\"%s\": null%s", key, last ? "" : ", ");
+
+	return;
+}
+
+static int bench_ns_cmp(const void *p1, const void *p2)
+{
+	const Bench *b1 = (const Bench *)p1, *b2 = (const Bench *)p2;
+
+	return (b1->ns > b2->ns) - (b1->ns < b2->ns);
+}
+
+/* runs a case repetitions times and reports the median run */
+static void bench_run(const BenchCase *c, size_t n, size_t ops, int threads, int repetitions, bool *first)
+{
+	Bench *runs = NULL, *b = NULL;
+	int r = 0;
+	bool allocs = false;
+
+#ifdef SLIST_BENCH_ALLOCS
+	allocs = true;
+#endif
+
+	runs = (Bench *)bench_check(calloc((size_t)repetitions, sizeof(Bench)));
+	for (r = 0; r < repetitions; r++) {
+		runs[r].n = n;
+		runs[r].ops = ops;
+		runs[r].threads = threads;
+		runs[r].rng = 0x2545F4914F6CDD1Du + (uint64_t)r;
+		c->func(&runs[r]);
+	}
+	qsort(runs, (size_t)repetitions, sizeof(Bench), bench_ns_cmp);
+	b = &runs[repetitions / 2];
+
+	printf("%s\n    {\"name\": \"%s\", \"size\": %zu, \"threads\": %d, \"ops\": %zu, ",
+	       *first ? "" : ",", c->name, n, threads, b->ops);
+	bench_print_per_op("ns_per_op", true, (double)b->ns, b->ops, false);
+	bench_print_per_op("allocs_per_op", allocs, (double)b->allocs, b->ops, false);
+	bench_print_per_op("cache_misses_per_op", bench_perf_fd >= 0, (double)b->misses, b->ops, true);
+	printf("}");
+	fflush(stdout);
+
+	*first = false;
+	free(runs);
+
+	return;
+}
+
+static void bench_usage(void)
+{
+	fprintf(stderr, "usage: slist_bench [-m max_size] [-w work] [-r repetitions] [-t max_threads] [-f filter]\n");
+	exit(2);
+
+	return;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t max_size = 1000000, work = (size_t)1 << 22, n = 0, ops = 0, i = 0, c = 0;
+	int repetitions = 1, max_threads = 64, threads = 0, opt = 0;
+	const char *filter = NULL;
+	bool first = true;
+
+	while ((opt = getopt(argc, argv, "m:w:r:t:f:")) != -1) {
+		switch (opt) {
+		case 'm': max_size = strtoull(optarg, NULL, 10); break;
+		case 'w': work = strtoull(optarg, NULL, 10); break;
+		case 'r': repetitions = atoi(optarg); break;
+		case 't': max_threads = atoi(optarg); break;
+		case 'f': filter = optarg; break;
+		default:  bench_usage();
+		}
+	}
+	if (max_size < 10 || work < 4 || repetitions < 1 || max_threads < 2) bench_usage();
+
+	bench_perf_open();
+
+	printf("{\n  \"benchmark\": \"slist\",\n  \"work\": %zu,\n  \"repetitions\": %d,\n", work, repetitions);
+	printf("  \"results\": [");
+
+	for (n = 10; n <= max_size; n *= 10) {
+		bench_vals = (long *)bench_check(malloc(n * sizeof(long)));
+		for (i = 0; i < n; i++) bench_vals[i] = (long)i;
+
+		for (c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+			if (bench_cases[c].scale == BENCH_THREADS) continue;
+			if (filter && strstr(bench_cases[c].name, filter) == NULL) continue;
+
+			ops = bench_cases[c].scale == BENCH_CONST ? work / 4 : work / n;
+			if (ops == 0) ops = 1;
+			bench_run(&bench_cases[c], n, ops, 1, repetitions, &first);
+		}
+
+		free(bench_vals);
+		bench_vals = NULL;
+		if (n > max_size / 10) break;
+	}
+
+	for (c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+		if (bench_cases[c].scale != BENCH_THREADS) continue;
+		if (filter && strstr(bench_cases[c].name, filter) == NULL) continue;
+
+		for (threads = 2; threads <= max_threads; threads *= 2)
+			bench_run(&bench_cases[c], work / 4, work / 4, threads, repetitions, &first);
+	}
+
+	printf("\n  ]\n}\n");
+
+	if (bench_perf_fd >= 0) close(bench_perf_fd);
+
+	return 0;
+}
@@ -0,0 +1,362 @@
+#include "slist_concurrent.h"
+
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <assert.h>
+
+/* same shape as SlistNode, next is atomic */
+struct SlistConcurrentNode {
+	_Atomic(struct SlistConcurrentNode *) next;
+	void *data;
+};
+
+typedef struct SlistConcurrentNode SlistConcurrentNode;
+
+struct SlistConcurrent {
+	_Alignas(64) _Atomic(SlistConcurrentNode *) head;  /* sentinel, consumers */
+	_Alignas(64) _Atomic(SlistConcurrentNode *) tail;  /* producers */
+	_Alignas(64) atomic_size_t count;
+
+	SlistDataFree *data_free;
+};
+
+/* hazard pointers: one record per thread, shared by every list. Records are
+   never freed, a thread that exits hands its record and its retired nodes
+   to the next thread that needs one. */
+#define SLIST_HAZARD_SLOTS 2
+#define SLIST_HAZARD_RETIRE_MIN 64
+
+struct SlistHazard {
+	_Atomic(void *) slot[SLIST_HAZARD_SLOTS];
+	atomic_bool active;
+	struct SlistHazard *next;  /* immutable once published */
+
+	SlistConcurrentNode **retired;
+	size_t retired_count;
+	size_t retired_size;
+};
+
+static _Atomic(struct SlistHazard *) slist_hazard_records;
+static atomic_size_t slist_hazard_record_count;
+
+static pthread_key_t slist_hazard_key;
+static pthread_once_t slist_hazard_once = PTHREAD_ONCE_INIT;
+static _Thread_local struct SlistHazard *slist_hazard_self;
+
+static struct SlistHazard *slist_hazard_acquire(void);
+static void *slist_hazard_protect(struct SlistHazard *hazard, int i, _Atomic(SlistConcurrentNode *) *src);
+static void slist_hazard_clear(struct SlistHazard *hazard);
+static void slist_hazard_retire(struct SlistHazard *hazard, SlistConcurrentNode *node);
+static void slist_hazard_scan(struct SlistHazard *hazard);
+static bool slist_hazard_is_held(void *node);
+
+// SlistConcurrent new
+SlistConcurrent *slist_concurrent_create(SlistDataFree *data_free)
+{
+	SlistConcurrent *list = NULL;
+	SlistConcurrentNode *sentinel = NULL;
+
+	list = (SlistConcurrent *)aligned_alloc(64, sizeof(SlistConcurrent));
+	if (list == NULL) return NULL;
+
+	sentinel = (SlistConcurrentNode *)malloc(sizeof(SlistConcurrentNode));
+	if (sentinel == NULL) {
+		free(list);
+		return NULL;
+	}
+
+	atomic_init(&sentinel->next, NULL);
+	sentinel->data = NULL;
+
+	atomic_init(&list->head, sentinel);
+	atomic_init(&list->tail, sentinel);
+	atomic_init(&list->count, 0);
+	list->data_free = data_free;
+
+	return list;
+}
+
+// SlistConcurrent free
+void slist_concurrent_destroy(SlistConcurrent *list)
+{
+	SlistConcurrentNode *p = NULL, *next = NULL;
+
+	assert(list != NULL);
+
+	p = atomic_load(&list->head);
+	while (p) {
+		next = atomic_load(&p->next);
+		free(p);
+		p = next;
+	}
+
+	free(list);
+
+	return;
+}
+
+void slist_concurrent_destroy_deep(SlistConcurrent *list)
+{
+	SlistConcurrentNode *p = NULL;
+
+	assert(list != NULL);
+
+	if (list->data_free) { /* no other thread is left, plain loads will do */
+		p = atomic_load(&atomic_load(&list->head)->next); /* skip the sentinel */
+		for (; p; p = atomic_load(&p->next))
+			list->data_free(p->data);
+	}
+
+	slist_concurrent_destroy(list);
+
+	return;
+}
+
+size_t slist_concurrent_count(SlistConcurrent *list)
+{
+	assert(list != NULL);
+
+	return atomic_load_explicit(&list->count, memory_order_relaxed);
+}
+
+/* the sentinel may be retired by a consumer meanwhile, it is read under a
+   hazard pointer like in slist_concurrent_remove_data_first */
+bool slist_concurrent_isempty(SlistConcurrent *list)
+{
+	struct SlistHazard *hazard = NULL;
+	SlistConcurrentNode *head = NULL, *next = NULL;
+
+	assert(list != NULL);
+
+	hazard = slist_hazard_acquire();
+	if (hazard == NULL) /* no record, fall back on the counter */
+		return atomic_load_explicit(&list->count, memory_order_relaxed) == 0;
+
+	head = slist_hazard_protect(hazard, 0, &list->head);
+	next = atomic_load(&head->next);
+	slist_hazard_clear(hazard);
+
+	return next == NULL;
+}
+
+// add_data --- lock-free, O(1)
+int slist_concurrent_add_data_last(SlistConcurrent *list, void *data)
+{
+	struct SlistHazard *hazard = NULL;
+	SlistConcurrentNode *node = NULL, *tail = NULL, *next = NULL;
+
+	assert(list != NULL);
+
+	hazard = slist_hazard_acquire();
+	if (hazard == NULL) return -1;
+
+	node = (SlistConcurrentNode *)malloc(sizeof(SlistConcurrentNode));
+	if (node == NULL) return -1;
+
+	atomic_init(&node->next, NULL);
+	node->data = data;
+
+	for (;;) {
+		tail = slist_hazard_protect(hazard, 0, &list->tail);
+		next = atomic_load(&tail->next);
+		if (tail != atomic_load(&list->tail)) continue;
+
+		if (next != NULL) { /* tail is lagging, help it along */
+			atomic_compare_exchange_weak(&list->tail, &tail, next);
+			continue;
+		}
+
+		if (atomic_compare_exchange_weak(&tail->next, &next, node)) {
+			atomic_compare_exchange_strong(&list->tail, &tail, node);
+			break;
+		}
+	}
+	slist_hazard_clear(hazard);
+
+	atomic_fetch_add_explicit(&list->count, 1, memory_order_relaxed);
+
+	return 0;
+}
+
+// remove --- lock-free, O(1)
+/* the first data node becomes the new sentinel, the old sentinel is retired */
+void *slist_concurrent_remove_data_first(SlistConcurrent *list)
+{
+	void *ret_data = NULL;
+	struct SlistHazard *hazard = NULL;
+	SlistConcurrentNode *head = NULL, *tail = NULL, *next = NULL;
+
+	assert(list != NULL);
+
+	hazard = slist_hazard_acquire();
+	if (hazard == NULL) return NULL;
+
+	for (;;) {
+		head = slist_hazard_protect(hazard, 0, &list->head);
+		tail = atomic_load(&list->tail);
+		next = slist_hazard_protect(hazard, 1, &head->next);
+		if (head != atomic_load(&list->head)) continue;
+
+		if (next == NULL) { /* empty */
+			slist_hazard_clear(hazard);
+			return NULL;
+		}
+
+		if (head == tail) { /* tail is lagging, help it along */
+			atomic_compare_exchange_weak(&list->tail, &tail, next);
+			continue;
+		}
+
+		ret_data = next->data;
+		if (atomic_compare_exchange_weak(&list->head, &head, next)) break;
+	}
+	slist_hazard_clear(hazard);
+
+	atomic_fetch_sub_explicit(&list->count, 1, memory_order_relaxed);
+
+	slist_hazard_retire(hazard, head);
+
+	return ret_data;
+}
+
+// hazard pointers
+static void slist_hazard_release(void *arg)
+{
+	struct SlistHazard *hazard = (struct SlistHazard *)arg;
+
+	slist_hazard_clear(hazard);
+	atomic_store(&hazard->active, false);
+
+	return;
+}
+
+static void slist_hazard_key_create(void)
+{
+	pthread_key_create(&slist_hazard_key, slist_hazard_release);
+
+	return;
+}
+
+static struct SlistHazard *slist_hazard_acquire(void)
+{
+	struct SlistHazard *hazard = NULL, *first = NULL;
+	bool inactive = false;
+	int i = 0;
+
+	if (slist_hazard_self != NULL) return slist_hazard_self;
+
+	pthread_once(&slist_hazard_once, slist_hazard_key_create);
+
+	/* reuse the record of a thread that has exited */
+	for (hazard = atomic_load(&slist_hazard_records); hazard; hazard = hazard->next) {
+		inactive = false;
+		if (atomic_compare_exchange_strong(&hazard->active, &inactive, true)) break;
+	}
+
+	if (hazard == NULL) {
+		hazard = (struct SlistHazard *)malloc(sizeof(struct SlistHazard));
+		if (hazard == NULL) return NULL;
+
+		for (i = 0; i < SLIST_HAZARD_SLOTS; i++)
+			atomic_init(&hazard->slot[i], NULL);
+		atomic_init(&hazard->active, true);
+		hazard->retired = NULL;
+		hazard->retired_count = 0;
+		hazard->retired_size = 0;
+
+		first = atomic_load(&slist_hazard_records);
+		do {
+			hazard->next = first;
+		} while (!atomic_compare_exchange_weak(&slist_hazard_records, &first, hazard));
+		atomic_fetch_add(&slist_hazard_record_count, 1);
+	}
+
+	pthread_setspecific(slist_hazard_key, hazard);
+	slist_hazard_self = hazard;
+
+	return hazard;
+}
+
+/* publish the pointer read from src and re-check that src still holds it */
+static void *slist_hazard_protect(struct SlistHazard *hazard, int i, _Atomic(SlistConcurrentNode *) *src)
+{
+	SlistConcurrentNode *p = NULL, *check = NULL;
+
+	p = atomic_load(src);
+	for (;;) {
+		atomic_store(&hazard->slot[i], (void *)p);
+		check = atomic_load(src);
+		if (check == p) return p;
+		p = check;
+	}
+}
+
+static void slist_hazard_clear(struct SlistHazard *hazard)
+{
+	int i = 0;
+
+	for (i = 0; i < SLIST_HAZARD_SLOTS; i++)
+		atomic_store_explicit(&hazard->slot[i], NULL, memory_order_release);
+
+	return;
+}
+
+/* true while some thread has node published */
+static bool slist_hazard_is_held(void *node)
+{
+	struct SlistHazard *h = NULL;
+	int i = 0;
+
+	for (h = atomic_load(&slist_hazard_records); h; h = h->next) {
+		for (i = 0; i < SLIST_HAZARD_SLOTS; i++) {
+			if (atomic_load(&h->slot[i]) == node) return true;
+		}
+	}
+
+	return false;
+}
+
+static void slist_hazard_retire(struct SlistHazard *hazard, SlistConcurrentNode *node)
+{
+	SlistConcurrentNode **retired = NULL;
+	size_t size = 0, threshold = 0;
+
+	if (hazard->retired_count == hazard->retired_size) {
+		size = hazard->retired_size ? hazard->retired_size * 2 : SLIST_HAZARD_RETIRE_MIN;
+		retired = (SlistConcurrentNode **)realloc(hazard->retired, size * sizeof(SlistConcurrentNode *));
+		if (retired == NULL) { /* cannot defer, wait until nobody holds it */
+			while (slist_hazard_is_held(node));
+			free(node);
+			return;
+		}
+		hazard->retired = retired;
+		hazard->retired_size = size;
+	}
+
+	hazard->retired[hazard->retired_count++] = node;
+
+	/* amortized O(1): scan once the list outgrows the possible hazards */
+	threshold = 2 * SLIST_HAZARD_SLOTS * atomic_load(&slist_hazard_record_count);
+	if (threshold < SLIST_HAZARD_RETIRE_MIN) threshold = SLIST_HAZARD_RETIRE_MIN;
+	if (hazard->retired_count >= threshold)
+		slist_hazard_scan(hazard);
+
+	return;
+}
+
+/* free every retired node no thread has published */
+static void slist_hazard_scan(struct SlistHazard *hazard)
+{
+	size_t i = 0, kept = 0;
+
+	for (i = 0; i < hazard->retired_count; i++) {
+		if (slist_hazard_is_held(hazard->retired[i]))
+			hazard->retired[kept++] = hazard->retired[i];
+		else
+			free(hazard->retired[i]);
+	}
+	hazard->retired_count = kept;
+
+	return;
+}
@@ -0,0 +1,30 @@
+#ifndef __SLIST_CONCURRENT_H__
+#define __SLIST_CONCURRENT_H__
+
+#include "slist.h"        /* share the data callback types */
+
+/* lock-free FIFO list (Michael-Scott) for any number of producers and
+   consumers. Append works on the tail pointer, removal on the first node,
+   removed nodes are reclaimed through hazard pointers. Needs -pthread. */
+typedef struct SlistConcurrent SlistConcurrent;
+
+// SlistConcurrent new
+SlistConcurrent *slist_concurrent_create(SlistDataFree *data_free);
+
+// SlistConcurrent free --- no other thread may use the list any more
+void slist_concurrent_destroy(SlistConcurrent *list);
+void slist_concurrent_destroy_deep(SlistConcurrent *list);
+
+// approximate while other threads add or remove
+size_t slist_concurrent_count(SlistConcurrent *list);
+
+// lock-free, exact at the moment it reads the first node
+bool slist_concurrent_isempty(SlistConcurrent *list);
+
+// add_data --- lock-free, O(1)
+int slist_concurrent_add_data_last(SlistConcurrent *list, void *data);
+
+// remove --- lock-free, O(1), NULL when the list is empty
+void *slist_concurrent_remove_data_first(SlistConcurrent *list);
+
+#endif //__SLIST_CONCURRENT_H__
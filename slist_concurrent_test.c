@@ -0,0 +1,192 @@
+/* stress test of SlistConcurrent with many producers and consumers.
+
+   usage: slist_concurrent_test [-t threads] [-n items] [-r rounds]
+
+   Every round starts fresh producers and consumers on one list. Each
+   producer adds items numbered uniquely, the consumers remove until the
+   producers are done and the list is empty, and every item must come out
+   exactly once. Items of one producer must also come out of one consumer
+   in the order they went in. Odd rounds stop the consumers half way and
+   destroy_deep has to hand over the rest. Threads exit between rounds so
+   their hazard records and retired nodes pass on to the next ones. Meant
+   to run under TSan or ASan. */
+
+#include "slist_concurrent.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define TEST_THREADS_MAX 16     /* producers, and as many consumers */
+
+#define CHECK(cond) do { if (!(cond)) test_fail(__LINE__, #cond); } while (0)
+
+typedef struct TestThread {
+	pthread_t thread;
+	int id;
+} TestThread;
+
+static SlistConcurrent *test_list;
+static int test_threads = 4;
+static long test_items = 100000;        /* per producer */
+static long test_round;
+static atomic_int test_producing;       /* producers still running */
+static atomic_long test_removed;        /* items taken by consumers */
+static long test_stop;                  /* consumers stop after so many */
+static atomic_uchar *test_seen;         /* times each item came out */
+
+static void test_fail(int line, const char *cond)
+{
+	fprintf(stderr, "slist_concurrent_test: line %d: %s failed, round %ld\n", line, cond, test_round);
+	exit(1);
+}
+
+// item --- producer and sequence packed in one non NULL pointer
+static void *test_item(int producer, long seq)
+{
+	return (void *)(uintptr_t)(1 + (uintptr_t)producer * (uintptr_t)test_items + (uintptr_t)seq);
+}
+
+static long test_item_index(void *data)
+{
+	uintptr_t i = (uintptr_t)data;
+
+	CHECK(i >= 1 && i <= (uintptr_t)test_threads * (uintptr_t)test_items);
+
+	return (long)(i - 1);
+}
+
+static void test_item_seen(void *data)
+{
+	long i = test_item_index(data);
+
+	CHECK(atomic_fetch_add(&test_seen[i], 1) == 0);
+
+	return;
+}
+
+static void *test_producer(void *arg)
+{
+	TestThread *self = (TestThread *)arg;
+	long seq = 0;
+
+	for (seq = 0; seq < test_items; seq++)
+		CHECK(slist_concurrent_add_data_last(test_list, test_item(self->id, seq)) == 0);
+
+	atomic_fetch_sub(&test_producing, 1);
+
+	return NULL;
+}
+
+static void *test_consumer(void *arg)
+{
+	long last[TEST_THREADS_MAX];
+	void *data = NULL;
+	long i = 0;
+	int p = 0;
+	bool done = false;
+
+	(void)arg;
+	for (p = 0; p < test_threads; p++) last[p] = -1;
+
+	for (;;) {
+		if (test_stop && atomic_load(&test_removed) >= test_stop) break;
+
+		done = atomic_load(&test_producing) == 0; /* read before the remove */
+		data = slist_concurrent_remove_data_first(test_list);
+		if (data == NULL) {
+			if (done) break;    /* every item was in before the list was empty */
+			sched_yield();
+			continue;
+		}
+
+		i = test_item_index(data);
+		p = (int)(i / test_items);
+		CHECK(i % test_items > last[p]);
+		last[p] = i % test_items;
+		test_item_seen(data);
+		atomic_fetch_add(&test_removed, 1);
+	}
+
+	return NULL;
+}
+
+static void test_run(long round)
+{
+	TestThread producers[TEST_THREADS_MAX], consumers[TEST_THREADS_MAX];
+	long total = test_threads * test_items, i = 0;
+	int t = 0;
+
+	test_round = round;
+	test_list = slist_concurrent_create(test_item_seen);
+	CHECK(test_list != NULL);
+	CHECK(slist_concurrent_isempty(test_list));
+
+	for (i = 0; i < total; i++) atomic_store(&test_seen[i], 0);
+	atomic_store(&test_producing, test_threads);
+	atomic_store(&test_removed, 0);
+	test_stop = round % 2 ? total / 2 : 0;
+
+	for (t = 0; t < test_threads; t++) {
+		consumers[t].id = t;
+		CHECK(pthread_create(&consumers[t].thread, NULL, test_consumer, &consumers[t]) == 0);
+		producers[t].id = t;
+		CHECK(pthread_create(&producers[t].thread, NULL, test_producer, &producers[t]) == 0);
+	}
+	for (t = 0; t < test_threads; t++) {
+		CHECK(pthread_join(producers[t].thread, NULL) == 0);
+		CHECK(pthread_join(consumers[t].thread, NULL) == 0);
+	}
+
+	if (test_stop == 0) {
+		CHECK(slist_concurrent_isempty(test_list));
+		CHECK(slist_concurrent_count(test_list) == 0);
+	}
+	else
+		CHECK(slist_concurrent_count(test_list) == (size_t)(total - atomic_load(&test_removed)));
+
+	slist_concurrent_destroy_deep(test_list);  /* the rest are seen here */
+	test_list = NULL;
+
+	for (i = 0; i < total; i++) CHECK(atomic_load(&test_seen[i]) == 1);
+
+	return;
+}
+
+static void test_usage(void)
+{
+	fprintf(stderr, "usage: slist_concurrent_test [-t threads] [-n items] [-r rounds]\n");
+	exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+	long rounds = 8, round = 0;
+	int opt = 0;
+
+	while ((opt = getopt(argc, argv, "t:n:r:")) != -1) {
+		switch (opt) {
+		case 't': test_threads = atoi(optarg); break;
+		case 'n': test_items = atol(optarg); break;
+		case 'r': rounds = atol(optarg); break;
+		default:  test_usage();
+		}
+	}
+	if (test_threads <= 0 || test_threads > TEST_THREADS_MAX || test_items <= 0 || rounds <= 0)
+		test_usage();
+
+	test_seen = (atomic_uchar *)calloc((size_t)test_threads * (size_t)test_items, sizeof(atomic_uchar));
+	CHECK(test_seen != NULL);
+
+	for (round = 0; round < rounds; round++) test_run(round);
+
+	free(test_seen);
+	printf("slist_concurrent_test: %ld rounds of %d producers and %d consumers x %ld items passed\n",
+	       rounds, test_threads, test_threads, test_items);
+
+	return 0;
+}
@@ -0,0 +1,324 @@
+#include "slist_heap.h"
+
+#include <stdlib.h>
+#include <assert.h>
+
+/* link.next is the next sibling, link.data the data. link comes first, so a
+   sibling pointer converts back to its heap node */
+struct SlistHeapNode {
+	SlistNode link;
+	struct SlistHeapNode *child;  /* first child, NULL for a leaf */
+	struct SlistHeapNode *prev;   /* parent of a first child, else the left sibling */
+};
+
+struct SlistHeap {
+	SlistHeapNode *root;  /* NULL when empty, no siblings */
+	size_t count;
+
+	SlistDataCmp  *data_cmp;
+	SlistDataFree *data_free;
+};
+
+#define SLIST_HEAP_NEXT(node) ((SlistHeapNode *)(node)->link.next)
+
+static SlistHeapNode *slist_heap_link(SlistHeap *heap, SlistHeapNode *a, SlistHeapNode *b);
+static SlistHeapNode *slist_heap_merge_pairs(SlistHeap *heap, SlistHeapNode *first);
+static void slist_heap_cut(SlistHeapNode *node);
+static void slist_heap_free_all(SlistHeap *heap, bool deep);
+
+// SlistHeap new
+SlistHeap *slist_heap_create(SlistDataCmp *data_cmp, SlistDataFree *data_free)
+{
+	SlistHeap *heap = NULL;
+
+	assert(data_cmp != NULL);
+
+	heap = (SlistHeap *)malloc(sizeof(SlistHeap));
+	if (heap == NULL) return NULL;
+
+	heap->root = NULL;
+	heap->count = 0;
+	heap->data_cmp = data_cmp;
+	heap->data_free = data_free;
+
+	return heap;
+}
+
+// SlistHeap free
+void slist_heap_destroy(SlistHeap *heap)
+{
+	assert(heap != NULL);
+	assert(heap->count == 0);
+
+	free(heap);
+
+	return;
+}
+
+void slist_heap_destroy_deep(SlistHeap *heap)
+{
+	assert(heap != NULL);
+
+	slist_heap_clear_deep(heap);
+	free(heap);
+
+	return;
+}
+
+// SlistHeap clear
+void slist_heap_clear(SlistHeap *heap)
+{
+	assert(heap != NULL);
+
+	slist_heap_free_all(heap, false);
+
+	return;
+}
+
+void slist_heap_clear_deep(SlistHeap *heap)
+{
+	assert(heap != NULL);
+
+	slist_heap_free_all(heap, true);
+
+	return;
+}
+
+/* no recursion: the children of the node about to go are hung in front of
+   its siblings, so every node is reached once along next */
+static void slist_heap_free_all(SlistHeap *heap, bool deep)
+{
+	SlistHeapNode *p = NULL, *last = NULL, *next = NULL;
+
+	for (p = heap->root; p; p = next) {
+		if (p->child) {
+			for (last = p->child; last->link.next; last = SLIST_HEAP_NEXT(last));
+			last->link.next = p->link.next;
+			p->link.next = (SlistNode *)p->child;
+		}
+		next = SLIST_HEAP_NEXT(p);
+
+		if (deep && heap->data_free) heap->data_free(p->link.data);
+		free(p);
+	}
+
+	heap->root = NULL;
+	heap->count = 0;
+
+	return;
+}
+
+size_t slist_heap_count(SlistHeap *heap)
+{
+	assert(heap != NULL);
+
+	return heap->count;
+}
+
+bool slist_heap_isempty(SlistHeap *heap)
+{
+	assert(heap != NULL);
+
+	return heap->count == 0;
+}
+
+/* two roots become one, the loser is the winner's new first child. on equal
+   data a stays on top */
+static SlistHeapNode *slist_heap_link(SlistHeap *heap, SlistHeapNode *a, SlistHeapNode *b)
+{
+	SlistHeapNode *t = NULL;
+
+	if (heap->data_cmp(b->link.data, a->link.data) < 0) {
+		t = a;
+		a = b;
+		b = t;
+	}
+
+	b->prev = a;
+	b->link.next = (SlistNode *)a->child;
+	if (a->child) a->child->prev = b;
+	a->child = b;
+
+	return a;
+}
+
+// insert --- O(1)
+SlistHeapNode *slist_heap_insert(SlistHeap *heap, void *data)
+{
+	SlistHeapNode *node = NULL;
+
+	assert(heap != NULL);
+
+	node = (SlistHeapNode *)malloc(sizeof(SlistHeapNode));
+	if (node == NULL) return NULL;
+
+	node->link.next = NULL;
+	node->link.data = data;
+	node->child = NULL;
+	node->prev = NULL;
+
+	heap->root = heap->root ? slist_heap_link(heap, heap->root, node) : node;
+	heap->count++;
+
+	return node;
+}
+
+//heap2's root is linked under heap1's or the other way round. O(1)
+void slist_heap_meld(SlistHeap *heap1, SlistHeap *heap2)
+{
+	assert(heap1 != NULL);
+	assert(heap2 != NULL);
+	assert(heap1 != heap2);
+	assert(heap1->data_cmp == heap2->data_cmp);
+
+	if (heap2->root == NULL) return;
+
+	heap1->root = heap1->root ? slist_heap_link(heap1, heap1->root, heap2->root) : heap2->root;
+	heap1->count += heap2->count;
+
+	heap2->root = NULL;
+	heap2->count = 0;
+
+	return;
+}
+
+// min --- O(1)
+void *slist_heap_min_data(SlistHeap *heap)
+{
+	assert(heap != NULL);
+
+	return heap->root ? heap->root->link.data : NULL;
+}
+
+SlistHeapNode *slist_heap_min_node(SlistHeap *heap)
+{
+	assert(heap != NULL);
+
+	return heap->root;
+}
+
+/* two pass pairing: neighbours are linked left to right and stacked through
+   next, then the stack is melded right to left into one root */
+static SlistHeapNode *slist_heap_merge_pairs(SlistHeap *heap, SlistHeapNode *first)
+{
+	SlistHeapNode *a = NULL, *b = NULL, *next = NULL, *pairs = NULL;
+
+	assert(first != NULL);
+
+	while (first) {
+		a = first;
+		b = SLIST_HEAP_NEXT(a);
+		if (b == NULL) {
+			a->link.next = (SlistNode *)pairs;
+			pairs = a;
+			break;
+		}
+		next = SLIST_HEAP_NEXT(b);
+
+		a = slist_heap_link(heap, a, b);
+		a->link.next = (SlistNode *)pairs;
+		pairs = a;
+
+		first = next;
+	}
+
+	a = pairs;
+	for (b = SLIST_HEAP_NEXT(a); b; b = next) {
+		next = SLIST_HEAP_NEXT(b);
+		a = slist_heap_link(heap, a, b);
+	}
+
+	a->link.next = NULL;
+	a->prev = NULL;
+
+	return a;
+}
+
+/* detach the subtree of a node that is not the root */
+static void slist_heap_cut(SlistHeapNode *node)
+{
+	SlistHeapNode *next = NULL;
+
+	assert(node->prev != NULL);
+
+	next = SLIST_HEAP_NEXT(node);
+	if (node->prev->child == node)
+		node->prev->child = next;
+	else
+		node->prev->link.next = (SlistNode *)next;
+	if (next) next->prev = node->prev;
+
+	node->link.next = NULL;
+	node->prev = NULL;
+
+	return;
+}
+
+// remove --- amortized O(logn)
+void *slist_heap_remove_min(SlistHeap *heap)
+{
+	SlistHeapNode *root = NULL;
+	void *data = NULL;
+
+	assert(heap != NULL);
+
+	root = heap->root;
+	if (root == NULL) return NULL;
+
+	heap->root = root->child ? slist_heap_merge_pairs(heap, root->child) : NULL;
+	heap->count--;
+
+	data = root->link.data;
+	free(root);
+
+	return data;
+}
+
+//the node's subtree is cut out, its children are paired up and linked back under the root
+void *slist_heap_remove_node(SlistHeap *heap, SlistHeapNode *node)
+{
+	SlistHeapNode *sub = NULL;
+	void *data = NULL;
+
+	assert(heap != NULL);
+	assert(node != NULL);
+
+	if (node == heap->root) return slist_heap_remove_min(heap);
+
+	slist_heap_cut(node);
+	if (node->child) {
+		sub = slist_heap_merge_pairs(heap, node->child);
+		heap->root = slist_heap_link(heap, heap->root, sub);
+	}
+	heap->count--;
+
+	data = node->link.data;
+	free(node);
+
+	return data;
+}
+
+//a smaller key can only break the order towards the parent, so the subtree
+//is cut and linked with the root
+int slist_heap_decrease_key(SlistHeap *heap, SlistHeapNode *node, void *data)
+{
+	assert(heap != NULL);
+	assert(node != NULL);
+
+	if (heap->data_cmp(data, node->link.data) > 0) return -1;
+
+	node->link.data = data;
+	if (node == heap->root) return 0;
+
+	slist_heap_cut(node);
+	heap->root = slist_heap_link(heap, heap->root, node);
+
+	return 0;
+}
+
+void *slist_heap_node_data(SlistHeapNode *node)
+{
+	assert(node != NULL);
+
+	return node->link.data;
+}
@@ -0,0 +1,47 @@
+#ifndef __SLIST_HEAP_H__
+#define __SLIST_HEAP_H__
+
+#include "slist.h"        /* share SlistNode and the data callback types */
+
+/* priority queue on data_cmp, smallest first, as a pairing heap. A heap node
+   is an SlistNode whose next chains siblings, plus a first child and a back
+   link, so a node is a handle the caller may keep until it is removed. */
+typedef struct SlistHeap SlistHeap;
+typedef struct SlistHeapNode SlistHeapNode;
+
+// SlistHeap new
+SlistHeap *slist_heap_create(SlistDataCmp *data_cmp, SlistDataFree *data_free);
+
+// SlistHeap free
+void slist_heap_destroy(SlistHeap *heap);
+void slist_heap_destroy_deep(SlistHeap *heap);
+
+// SlistHeap clear --- O(n), every handle becomes invalid
+void slist_heap_clear(SlistHeap *heap);
+void slist_heap_clear_deep(SlistHeap *heap);
+
+size_t slist_heap_count(SlistHeap *heap);
+
+bool slist_heap_isempty(SlistHeap *heap);
+
+// insert --- O(1), NULL when out of memory
+SlistHeapNode *slist_heap_insert(SlistHeap *heap, void *data);
+
+//all nodes of heap2 move into heap1, heap2 stays empty. O(1), handles stay valid.
+void slist_heap_meld(SlistHeap *heap1, SlistHeap *heap2);
+
+// min --- O(1), NULL for an empty heap
+void *slist_heap_min_data(SlistHeap *heap);
+SlistHeapNode *slist_heap_min_node(SlistHeap *heap);
+
+// remove --- amortized O(logn), NULL for an empty heap
+void *slist_heap_remove_min(SlistHeap *heap);
+void *slist_heap_remove_node(SlistHeap *heap, SlistHeapNode *node);
+
+//data replaces the node's data and must not be greater, -1 if it is.
+//amortized O(logn), O(1) in practice
+int slist_heap_decrease_key(SlistHeap *heap, SlistHeapNode *node, void *data);
+
+void *slist_heap_node_data(SlistHeapNode *node);
+
+#endif //__SLIST_HEAP_H__
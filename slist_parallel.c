@@ -0,0 +1,288 @@
+#include "slist_parallel.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <assert.h>
+
+enum {
+	SLIST_PARALLEL_FOR_EACH,
+	SLIST_PARALLEL_COUNT_IF,
+	SLIST_PARALLEL_FILTER,
+	SLIST_PARALLEL_REDUCE
+};
+
+/* one segment of the list and what to do with it */
+struct SlistParallelTask {
+	int op;
+	SlistCursor start;
+	size_t count;
+	size_t first;            /* index of the segment's first data */
+
+	SlistDataVisit  *visit;
+	SlistDataFind   *data_find;
+	SlistDataReduce *reduce;
+	void *user_data;
+
+	unsigned char *keep;     /* filter: one flag per data of the list */
+	size_t matched;          /* count_if and filter */
+	void *acc;               /* reduce */
+
+	pthread_t thread;
+	bool spawned;
+};
+
+typedef struct SlistParallelTask SlistParallelTask;
+
+/* teardowns handed to background threads and not finished yet */
+static pthread_mutex_t slist_parallel_destroy_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t slist_parallel_destroy_done = PTHREAD_COND_INITIALIZER;
+static size_t slist_parallel_destroy_pending = 0;
+
+static void *slist_parallel_worker(void *arg);
+static SlistParallelTask *slist_parallel_run(Slist *list, SlistParallelTask *proto, int *threads);
+static void *slist_parallel_destroyer(void *arg);
+
+static void *slist_parallel_worker(void *arg)
+{
+	SlistParallelTask *task = (SlistParallelTask *)arg;
+	SlistCursor cursor = task->start;
+	size_t i = 0;
+	void *data = NULL;
+
+	for (i = 0; i < task->count; i++, slist_cursor_next(&cursor)) {
+		data = slist_cursor_peek(&cursor);
+
+		switch (task->op) {
+		case SLIST_PARALLEL_FOR_EACH:
+			task->visit(data, task->user_data);
+			break;
+		case SLIST_PARALLEL_COUNT_IF:
+			if (task->data_find(data, task->user_data) == 0) task->matched++;
+			break;
+		case SLIST_PARALLEL_FILTER:
+			task->keep[task->first + i] = task->data_find(data, task->user_data) == 0;
+			if (task->keep[task->first + i]) task->matched++;
+			break;
+		case SLIST_PARALLEL_REDUCE:
+			task->acc = task->reduce(task->acc, data, task->user_data);
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+/* cut the list into *threads segments in one walk and run them, the calling
+   thread takes the first segment. *threads receives the segments used. */
+static SlistParallelTask *slist_parallel_run(Slist *list, SlistParallelTask *proto, int *threads)
+{
+	SlistParallelTask *tasks = NULL;
+	SlistCursor cursor;
+	size_t count = 0, first = 0, i = 0;
+	long cpus = 0;
+	int n = *threads, t = 0;
+
+	assert(list != NULL);
+	assert(proto != NULL);
+
+	count = slist_count(list);
+
+	if (n <= 0) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		n = cpus > 0 ? (int)cpus : 1;
+	}
+	if ((size_t)n > count) n = count > 0 ? (int)count : 1;
+
+	tasks = (SlistParallelTask *)calloc(n, sizeof(SlistParallelTask));
+	if (tasks == NULL) return NULL;
+
+	slist_cursor_init(&cursor, list);
+	for (t = 0; t < n; t++) {
+		tasks[t] = *proto;
+		tasks[t].start = cursor;
+		tasks[t].count = count / n + ((size_t)t < count % n);
+		tasks[t].first = first;
+		tasks[t].spawned = false;
+
+		first += tasks[t].count;
+		if (t + 1 < n) {
+			for (i = 0; i < tasks[t].count; i++) slist_cursor_next(&cursor);
+		}
+	}
+
+	for (t = 1; t < n; t++) {
+		if (pthread_create(&tasks[t].thread, NULL, slist_parallel_worker, &tasks[t]) == 0)
+			tasks[t].spawned = true;
+	}
+
+	slist_parallel_worker(&tasks[0]);
+
+	for (t = 1; t < n; t++) {
+		if (tasks[t].spawned)
+			pthread_join(tasks[t].thread, NULL);
+		else /* could not spawn, do it here */
+			slist_parallel_worker(&tasks[t]);
+	}
+
+	*threads = n;
+
+	return tasks;
+}
+
+int slist_parallel_for_each(Slist *list, SlistDataVisit *visit, void *user_data, int threads)
+{
+	SlistParallelTask proto = {0}, *tasks = NULL;
+
+	assert(list != NULL);
+	assert(visit != NULL);
+
+	proto.op = SLIST_PARALLEL_FOR_EACH;
+	proto.visit = visit;
+	proto.user_data = user_data;
+
+	tasks = slist_parallel_run(list, &proto, &threads);
+	if (tasks == NULL) return -1;
+
+	free(tasks);
+
+	return 0;
+}
+
+size_t slist_parallel_count_if(Slist *list, SlistDataFind *data_find, void *user_data, int threads)
+{
+	SlistParallelTask proto = {0}, *tasks = NULL;
+	size_t matched = 0;
+	int t = 0;
+
+	assert(list != NULL);
+	assert(data_find != NULL);
+
+	proto.op = SLIST_PARALLEL_COUNT_IF;
+	proto.data_find = data_find;
+	proto.user_data = user_data;
+
+	tasks = slist_parallel_run(list, &proto, &threads);
+	if (tasks == NULL) return 0;
+
+	for (t = 0; t < threads; t++)
+		matched += tasks[t].matched;
+	free(tasks);
+
+	return matched;
+}
+
+/* the callbacks run in parallel, the unlinking is one cursor pass afterwards */
+size_t slist_parallel_filter(Slist *list, SlistDataFind *data_find, void *user_data, int threads)
+{
+	SlistParallelTask proto = {0}, *tasks = NULL;
+	SlistCursor cursor;
+	size_t count = 0, removed = 0, i = 0;
+
+	assert(list != NULL);
+	assert(data_find != NULL);
+
+	count = slist_count(list);
+	if (count == 0) return 0;
+
+	proto.op = SLIST_PARALLEL_FILTER;
+	proto.data_find = data_find;
+	proto.user_data = user_data;
+	proto.keep = (unsigned char *)malloc(count);
+	if (proto.keep == NULL) return 0;
+
+	tasks = slist_parallel_run(list, &proto, &threads);
+	if (tasks == NULL) {
+		free(proto.keep);
+		return 0;
+	}
+	free(tasks);
+
+	slist_cursor_init(&cursor, list);
+	for (i = 0; i < count; i++) {
+		if (proto.keep[i]) {
+			slist_cursor_next(&cursor);
+			continue;
+		}
+		slist_cursor_remove_deep(&cursor);
+		removed++;
+	}
+	free(proto.keep);
+
+	return removed;
+}
+
+void *slist_parallel_reduce(Slist *list, SlistDataReduce *reduce, SlistDataCombine *combine, void *user_data, int threads)
+{
+	SlistParallelTask proto = {0}, *tasks = NULL;
+	void *acc = NULL;
+	int t = 0;
+
+	assert(list != NULL);
+	assert(reduce != NULL);
+	assert(combine != NULL);
+
+	if (slist_count(list) == 0) return NULL;
+
+	proto.op = SLIST_PARALLEL_REDUCE;
+	proto.reduce = reduce;
+	proto.user_data = user_data;
+
+	tasks = slist_parallel_run(list, &proto, &threads);
+	if (tasks == NULL) return NULL;
+
+	/* fixed left to right order, the result does not depend on timing */
+	acc = tasks[0].acc;
+	for (t = 1; t < threads; t++)
+		acc = combine(acc, tasks[t].acc, user_data);
+	free(tasks);
+
+	return acc;
+}
+
+// background teardown
+static void *slist_parallel_destroyer(void *arg)
+{
+	slist_destroy_deep((Slist *)arg);
+
+	pthread_mutex_lock(&slist_parallel_destroy_lock);
+	if (--slist_parallel_destroy_pending == 0)
+		pthread_cond_broadcast(&slist_parallel_destroy_done);
+	pthread_mutex_unlock(&slist_parallel_destroy_lock);
+
+	return NULL;
+}
+
+int slist_parallel_destroy_deep(Slist *list)
+{
+	pthread_attr_t attr;
+	pthread_t thread;
+	int ret = -1;
+
+	assert(list != NULL);
+
+	pthread_mutex_lock(&slist_parallel_destroy_lock);
+	slist_parallel_destroy_pending++;
+	pthread_mutex_unlock(&slist_parallel_destroy_lock);
+
+	if (pthread_attr_init(&attr) == 0) {
+		if (pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) == 0 &&
+		    pthread_create(&thread, &attr, slist_parallel_destroyer, list) == 0)
+			ret = 0;
+		pthread_attr_destroy(&attr);
+	}
+
+	if (ret != 0) slist_parallel_destroyer(list);
+
+	return ret;
+}
+
+void slist_parallel_destroy_wait(void)
+{
+	pthread_mutex_lock(&slist_parallel_destroy_lock);
+	while (slist_parallel_destroy_pending > 0)
+		pthread_cond_wait(&slist_parallel_destroy_done, &slist_parallel_destroy_lock);
+	pthread_mutex_unlock(&slist_parallel_destroy_lock);
+
+	return;
+}
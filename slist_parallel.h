@@ -0,0 +1,41 @@
+#ifndef __SLIST_PARALLEL_H__
+#define __SLIST_PARALLEL_H__
+
+#include "slist.h"
+
+/* bulk traversal on worker threads. The list is cut into threads segments
+   of about equal length in one walk, every segment runs on its own thread
+   and results are merged in list order. Callbacks run concurrently and must
+   not modify the list. threads == 0 uses every online cpu. Needs -pthread. */
+
+typedef void  SlistDataVisit(void *data, void *user_data);
+/* fold data into acc, acc is NULL for the first data of a segment */
+typedef void *SlistDataReduce(void *acc, void *data, void *user_data);
+/* merge two partial results, acc1 comes from the earlier segment */
+typedef void *SlistDataCombine(void *acc1, void *acc2, void *user_data);
+
+int slist_parallel_for_each(Slist *list, SlistDataVisit *visit, void *user_data, int threads);
+
+//counts data with data_find(data, user_data) == 0
+size_t slist_parallel_count_if(Slist *list, SlistDataFind *data_find, void *user_data, int threads);
+
+//keeps data with data_find(data, user_data) == 0, frees the rest with the
+//list's data_free. returns the number removed.
+size_t slist_parallel_filter(Slist *list, SlistDataFind *data_find, void *user_data, int threads);
+
+//NULL for an empty list
+void *slist_parallel_reduce(Slist *list, SlistDataReduce *reduce, SlistDataCombine *combine, void *user_data, int threads);
+
+//runs slist_destroy_deep on a detached thread and returns at once.
+//data_free runs on that thread.
+//until slist_parallel_destroy_wait returns, do not touch:
+//  - a pool the list shares with other lists, or destroy it;
+//  - lists that share nodes with it through slist_copy_lazy.
+//a list on its own inline pool or without a pool shares nothing.
+//-1: no thread, the list was destroyed here.
+int slist_parallel_destroy_deep(Slist *list);
+
+//waits for every teardown started so far
+void slist_parallel_destroy_wait(void);
+
+#endif //__SLIST_PARALLEL_H__
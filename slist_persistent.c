@@ -0,0 +1,220 @@
+#include "slist_persistent.h"
+
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <assert.h>
+
+/* next and data never change once the node is published */
+struct SlistPersistentNode {
+	struct SlistPersistentNode *next;  /* holds one reference */
+	void *data;
+	atomic_size_t refs;  /* versions and nodes pointing here */
+};
+
+typedef struct SlistPersistentNode SlistPersistentNode;
+
+struct SlistPersistent {
+	atomic_size_t refs;  /* holders of this version */
+	SlistPersistentNode *first;  /* holds one reference */
+	size_t count;
+
+	SlistDataEqu  *data_equ;
+	SlistDataFree *data_free;
+};
+
+static SlistPersistent *slist_persistent_version(SlistPersistent *from, SlistPersistentNode *first, size_t count);
+static void slist_persistent_node_release(SlistPersistent *version, SlistPersistentNode *node);
+
+// SlistPersistent new
+SlistPersistent *slist_persistent_create(SlistDataEqu *data_equ, SlistDataFree *data_free)
+{
+	SlistPersistent *version = NULL;
+
+	version = (SlistPersistent *)malloc(sizeof(SlistPersistent));
+	if (version == NULL) return NULL;
+
+	atomic_init(&version->refs, 1);
+	version->first = NULL;
+	version->count = 0;
+	version->data_equ = data_equ;
+	version->data_free = data_free;
+
+	return version;
+}
+
+/* a new version of count nodes from first, the caller's reference on first
+   moves to it */
+static SlistPersistent *slist_persistent_version(SlistPersistent *from, SlistPersistentNode *first, size_t count)
+{
+	SlistPersistent *version = NULL;
+
+	version = slist_persistent_create(from->data_equ, from->data_free);
+	if (version == NULL) return NULL;
+
+	version->first = first;
+	version->count = count;
+
+	return version;
+}
+
+SlistPersistent *slist_persistent_retain(SlistPersistent *version)
+{
+	assert(version != NULL);
+
+	atomic_fetch_add_explicit(&version->refs, 1, memory_order_relaxed);
+
+	return version;
+}
+
+// SlistPersistent free
+void slist_persistent_release(SlistPersistent *version)
+{
+	assert(version != NULL);
+
+	/* acq_rel: the last holder sees every earlier holder's reads done */
+	if (atomic_fetch_sub_explicit(&version->refs, 1, memory_order_acq_rel) != 1) return;
+
+	slist_persistent_node_release(version, version->first);
+	free(version);
+
+	return;
+}
+
+/* drop one reference on node, a node that goes drops its successor, no recursion */
+static void slist_persistent_node_release(SlistPersistent *version, SlistPersistentNode *node)
+{
+	SlistPersistentNode *next = NULL;
+
+	while (node) {
+		if (atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) != 1) return;
+
+		next = node->next;
+		if (version->data_free) version->data_free(node->data);
+		free(node);
+		node = next;
+	}
+
+	return;
+}
+
+size_t slist_persistent_count(SlistPersistent *version)
+{
+	assert(version != NULL);
+
+	return version->count;
+}
+
+bool slist_persistent_isempty(SlistPersistent *version)
+{
+	assert(version != NULL);
+
+	return version->count == 0;
+}
+
+// new versions --- O(1)
+SlistPersistent *slist_persistent_add_data_first(SlistPersistent *version, void *data)
+{
+	SlistPersistent *new_version = NULL;
+	SlistPersistentNode *node = NULL;
+
+	assert(version != NULL);
+
+	node = (SlistPersistentNode *)malloc(sizeof(SlistPersistentNode));
+	if (node == NULL) return NULL;
+
+	node->next = version->first;
+	node->data = data;
+	atomic_init(&node->refs, 1);
+	if (node->next)
+		atomic_fetch_add_explicit(&node->next->refs, 1, memory_order_relaxed);
+
+	new_version = slist_persistent_version(version, node, version->count + 1);
+	if (new_version == NULL) {
+		if (node->next) /* version still holds it, never the last reference */
+			atomic_fetch_sub_explicit(&node->next->refs, 1, memory_order_relaxed);
+		free(node);
+		return NULL;
+	}
+
+	return new_version;
+}
+
+int slist_persistent_remove_data_first(SlistPersistent *version, SlistPersistent **out, void **data)
+{
+	SlistPersistent *new_version = NULL;
+	SlistPersistentNode *first = NULL;
+
+	assert(version != NULL);
+	assert(out != NULL);
+	assert(data != NULL);
+
+	*out = NULL;
+	*data = NULL;
+	if (version->count == 0) return -1;
+
+	first = version->first->next;
+	if (first)
+		atomic_fetch_add_explicit(&first->refs, 1, memory_order_relaxed);
+
+	new_version = slist_persistent_version(version, first, version->count - 1);
+	if (new_version == NULL) {
+		if (first)
+			atomic_fetch_sub_explicit(&first->refs, 1, memory_order_relaxed);
+		return -2;
+	}
+
+	*out = new_version;
+	*data = version->first->data;
+
+	return 0;
+}
+
+// read --- O(1) or O(n)
+void *slist_persistent_first_data(SlistPersistent *version)
+{
+	assert(version != NULL);
+
+	return version->first ? version->first->data : NULL;
+}
+
+void *slist_persistent_get_data_by_index(SlistPersistent *version, size_t index)
+{
+	SlistPersistentNode *p = NULL;
+
+	assert(version != NULL);
+
+	if (index >= version->count) return NULL;
+
+	for (p = version->first; index > 0; index--) p = p->next;
+
+	return p->data;
+}
+
+long slist_persistent_get_index_by_data(SlistPersistent *version, void *data)
+{
+	SlistPersistentNode *p = NULL;
+	long index = 0;
+
+	assert(version != NULL);
+	assert(version->data_equ != NULL);
+
+	for (p = version->first; p; p = p->next, index++) {
+		if (version->data_equ(p->data, data)) return index;
+	}
+
+	return -1;
+}
+
+void *slist_persistent_get_data_custom(SlistPersistent *version, SlistDataFind *data_find, void *user_data)
+{
+	SlistPersistentNode *p = NULL;
+
+	assert(version != NULL);
+	assert(data_find != NULL);
+
+	for (p = version->first; p; p = p->next) {
+		if (data_find(p->data, user_data) == 0) return p->data;
+	}
+
+	return NULL;
+}
@@ -0,0 +1,40 @@
+#ifndef __SLIST_PERSISTENT_H__
+#define __SLIST_PERSISTENT_H__
+
+#include "slist.h"        /* share the data callback types */
+
+/* immutable list versions. Prepend and pop-first build a new version in O(1)
+   that shares every further node with the old one, nodes are reference
+   counted and freed with the last version that reaches them. A version never
+   changes, so any number of threads may read a version they hold while other
+   threads derive new versions and release old ones. Needs -pthread. */
+typedef struct SlistPersistent SlistPersistent;
+
+// empty version, data_free runs when the last version holding a data goes
+SlistPersistent *slist_persistent_create(SlistDataEqu *data_equ, SlistDataFree *data_free);
+
+// snapshot --- O(1), another hold on the same version
+SlistPersistent *slist_persistent_retain(SlistPersistent *version);
+
+// drop a hold, nodes no other version reaches are freed with their data
+void slist_persistent_release(SlistPersistent *version);
+
+size_t slist_persistent_count(SlistPersistent *version);
+
+bool slist_persistent_isempty(SlistPersistent *version);
+
+// new versions --- O(1), version itself stays as it was, NULL when out of memory
+SlistPersistent *slist_persistent_add_data_first(SlistPersistent *version, void *data);
+
+//*out receives the new version and *data the first data, which lives as
+//long as version does. -1 for an empty version, -2 out of memory; *out and
+//*data are NULL then.
+int slist_persistent_remove_data_first(SlistPersistent *version, SlistPersistent **out, void **data);
+
+// read --- no locks, version must be held
+void *slist_persistent_first_data(SlistPersistent *version);
+void *slist_persistent_get_data_by_index(SlistPersistent *version, size_t index);   // O(n)
+long slist_persistent_get_index_by_data(SlistPersistent *version, void *data);
+void *slist_persistent_get_data_custom(SlistPersistent *version, SlistDataFind *data_find, void *user_data);
+
+#endif //__SLIST_PERSISTENT_H__
@@ -0,0 +1,212 @@
+#include "slist_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <assert.h>
+
+/* head and tail count up forever and are masked on use, tail - head is the
+   count. Each side keeps a copy of the other side's index on its own line and
+   reloads it only when the ring looks full or empty, so in steady state the
+   lines cross between the cores once per wrap and not once per data. */
+struct SlistRing {
+	_Alignas(64) atomic_size_t head;  /* next slot to remove, consumer */
+	size_t tail_cache;                /* consumer's last view of tail */
+	_Alignas(64) atomic_size_t tail;  /* next slot to fill, producer */
+	size_t head_cache;                /* producer's last view of head */
+
+	_Alignas(64) size_t mask;         /* capacity - 1 */
+	SlistDataFree *data_free;
+	void *slots[];
+};
+
+static size_t slist_ring_free_slots(SlistRing *ring, size_t tail);
+static size_t slist_ring_used_slots(SlistRing *ring, size_t head);
+
+// SlistRing new
+SlistRing *slist_ring_create(size_t capacity, SlistDataFree *data_free)
+{
+	SlistRing *ring = NULL;
+	size_t size = 1, bytes = 0;
+
+	if (capacity == 0 || capacity > ((size_t)-1 >> 1) / sizeof(void *)) return NULL;
+
+	while (size < capacity) size <<= 1;
+
+	bytes = sizeof(SlistRing) + size * sizeof(void *);
+	bytes = (bytes + 63) & ~(size_t)63; /* aligned_alloc wants a multiple */
+
+	ring = (SlistRing *)aligned_alloc(64, bytes);
+	if (ring == NULL) return NULL;
+
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	ring->tail_cache = 0;
+	ring->head_cache = 0;
+	ring->mask = size - 1;
+	ring->data_free = data_free;
+
+	return ring;
+}
+
+// SlistRing free
+void slist_ring_destroy(SlistRing *ring)
+{
+	assert(ring != NULL);
+
+	free(ring);
+
+	return;
+}
+
+void slist_ring_destroy_deep(SlistRing *ring)
+{
+	void *data = NULL;
+
+	assert(ring != NULL);
+
+	while (!slist_ring_isempty(ring)) {
+		data = slist_ring_remove_data_first(ring);
+		if (ring->data_free) ring->data_free(data);
+	}
+
+	slist_ring_destroy(ring);
+
+	return;
+}
+
+size_t slist_ring_capacity(SlistRing *ring)
+{
+	assert(ring != NULL);
+
+	return ring->mask + 1;
+}
+
+size_t slist_ring_count(SlistRing *ring)
+{
+	size_t head = 0, tail = 0;
+
+	assert(ring != NULL);
+
+	/* head first: tail only grows past it, by more than capacity at worst
+	   when both threads moved between the two loads */
+	head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	return tail - head <= ring->mask ? tail - head : ring->mask + 1;
+}
+
+bool slist_ring_isempty(SlistRing *ring)
+{
+	return slist_ring_count(ring) == 0;
+}
+
+/* producer side: slots free from tail on. acquire pairs with the consumer's
+   release of head, its reads of those slots are done */
+static size_t slist_ring_free_slots(SlistRing *ring, size_t tail)
+{
+	size_t capacity = ring->mask + 1;
+
+	if (tail - ring->head_cache == capacity)
+		ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	return capacity - (tail - ring->head_cache);
+}
+
+/* consumer side: slots filled from head on. acquire pairs with the
+   producer's release of tail, its writes to those slots are visible */
+static size_t slist_ring_used_slots(SlistRing *ring, size_t head)
+{
+	if (ring->tail_cache == head)
+		ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	return ring->tail_cache - head;
+}
+
+// add_data --- producer only
+int slist_ring_add_data_last(SlistRing *ring, void *data)
+{
+	size_t tail = 0;
+
+	assert(ring != NULL);
+
+	tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	if (slist_ring_free_slots(ring, tail) == 0) return -1;
+
+	ring->slots[tail & ring->mask] = data;
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+	return 0;
+}
+
+//copied in at most two runs, the second one after the wrap
+size_t slist_ring_add_data_last_batch(SlistRing *ring, void **data, size_t n)
+{
+	size_t tail = 0, room = 0, at = 0, run = 0;
+
+	assert(ring != NULL);
+	assert(data != NULL || n == 0);
+
+	tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	room = slist_ring_free_slots(ring, tail);
+	if (room < n && room < ring->mask + 1) { /* the cached head may be old */
+		ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+		room = slist_ring_free_slots(ring, tail);
+	}
+	if (n > room) n = room;
+	if (n == 0) return 0;
+
+	at = tail & ring->mask;
+	run = ring->mask + 1 - at;
+	if (run > n) run = n;
+	memcpy(&ring->slots[at], data, run * sizeof(void *));
+	memcpy(&ring->slots[0], data + run, (n - run) * sizeof(void *));
+
+	atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+
+	return n;
+}
+
+// remove --- consumer only
+void *slist_ring_remove_data_first(SlistRing *ring)
+{
+	size_t head = 0;
+	void *data = NULL;
+
+	assert(ring != NULL);
+
+	head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	if (slist_ring_used_slots(ring, head) == 0) return NULL;
+
+	data = ring->slots[head & ring->mask];
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+	return data;
+}
+
+size_t slist_ring_remove_data_first_batch(SlistRing *ring, void **data, size_t n)
+{
+	size_t head = 0, ready = 0, at = 0, run = 0;
+
+	assert(ring != NULL);
+	assert(data != NULL || n == 0);
+
+	head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	ready = slist_ring_used_slots(ring, head);
+	if (ready < n && ready > 0) { /* the cached tail may be old */
+		ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+		ready = slist_ring_used_slots(ring, head);
+	}
+	if (n > ready) n = ready;
+	if (n == 0) return 0;
+
+	at = head & ring->mask;
+	run = ring->mask + 1 - at;
+	if (run > n) run = n;
+	memcpy(data, &ring->slots[at], run * sizeof(void *));
+	memcpy(data + run, &ring->slots[0], (n - run) * sizeof(void *));
+
+	atomic_store_explicit(&ring->head, head + n, memory_order_release);
+
+	return n;
+}
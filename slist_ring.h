@@ -0,0 +1,36 @@
+#ifndef __SLIST_RING_H__
+#define __SLIST_RING_H__
+
+#include "slist.h"        /* share the data callback types */
+
+/* bounded FIFO for one producer thread and one consumer thread. Data sit in
+   a ring of power of two slots allocated once, push and pop are wait-free
+   and touch no allocator, the two indices live on cache lines of their own.
+   Needs -pthread. */
+typedef struct SlistRing SlistRing;
+
+// SlistRing new --- capacity is rounded up to a power of two, NULL for 0
+SlistRing *slist_ring_create(size_t capacity, SlistDataFree *data_free);
+
+// SlistRing free --- neither thread may use the ring any more
+void slist_ring_destroy(SlistRing *ring);
+void slist_ring_destroy_deep(SlistRing *ring);
+
+size_t slist_ring_capacity(SlistRing *ring);
+
+// exact on either thread when the other is idle, approximate otherwise
+size_t slist_ring_count(SlistRing *ring);
+
+bool slist_ring_isempty(SlistRing *ring);
+
+// add_data --- producer only, wait-free, O(1), -1 when full
+int slist_ring_add_data_last(SlistRing *ring, void *data);
+//as many of data as fit, one index update. returns the number added
+size_t slist_ring_add_data_last_batch(SlistRing *ring, void **data, size_t n);
+
+// remove --- consumer only, wait-free, O(1), NULL when empty
+void *slist_ring_remove_data_first(SlistRing *ring);
+//up to n data, one index update. returns the number removed
+size_t slist_ring_remove_data_first_batch(SlistRing *ring, void **data, size_t n);
+
+#endif //__SLIST_RING_H__
@@ -0,0 +1,777 @@
+/* differential test of slist against an array model.
+
+   usage: slist_test [-s seeds] [-n steps]
+
+   Every step picks one of a few lists and runs a random operation on it
+   and on its model, then compares every list with its model. Lists hold
+   longs by pointer on malloc nodes, by pointer on one shared pool, or
+   inline on a pool of their own each, so splices cross pools in the last
+   mode. Lazy and eager copies, splits, splices, merges, the set functions,
+   cursors, index, hash, prefetch table and compaction all take part. A
+   failure prints the mode, seed and step to replay it. */
+
+#define _GNU_SOURCE
+
+#include "slist.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#define TEST_LISTS 8            /* lists alive at once */
+#define TEST_CAP   256          /* model capacity, long lists stop growing */
+#define TEST_VALS  64           /* data drawn from 1..TEST_VALS, never NULL */
+#define TEST_OPS   34
+
+#define CHECK(cond) do { if (!(cond)) test_fail(__LINE__, #cond); } while (0)
+
+enum {
+	TEST_MALLOC,    /* pointer data, malloc nodes */
+	TEST_POOL,      /* pointer data, every list on one pool */
+	TEST_INLINE,    /* inline data, every new list on a pool of its own */
+	TEST_MODES
+};
+
+typedef struct TestList {
+	Slist *list;
+	long vals[TEST_CAP];
+	size_t n;
+	bool hash;      /* remove_one_by_data may then take any equal data */
+} TestList;
+
+static const char *test_mode_names[TEST_MODES] = { "malloc", "pool", "inline" };
+
+static TestList test_lists[TEST_LISTS];
+static SlistNodePool *test_pool;
+static int test_mode;
+static unsigned long test_seed;
+static long test_step;
+static int test_op;
+static uint64_t test_rng;
+static long test_buf[8];        /* inline data are copied from here */
+
+static void test_fail(int line, const char *cond)
+{
+	fprintf(stderr, "slist_test: line %d: %s failed, mode %s seed %lu step %ld op %d\n",
+	        line, cond, test_mode_names[test_mode], test_seed, test_step, test_op);
+	exit(1);
+}
+
+static size_t test_rand(size_t n)
+{
+	test_rng ^= test_rng << 13;
+	test_rng ^= test_rng >> 7;
+	test_rng ^= test_rng << 17;
+
+	return n ? (size_t)(test_rng % n) : 0;
+}
+
+// data --- a long by value or by pointer, the same to the model
+static void *test_data(long v, int slot)
+{
+	if (test_mode != TEST_INLINE) return (void *)(intptr_t)v;
+
+	test_buf[slot] = v;
+
+	return &test_buf[slot];
+}
+
+static long test_val(void *data)
+{
+	if (test_mode != TEST_INLINE) return (long)(intptr_t)data;
+
+	return *(long *)data;
+}
+
+static int test_cmp(void *data1, void *data2)
+{
+	long a = test_val(data1), b = test_val(data2);
+
+	return a < b ? -1 : a > b;
+}
+
+static bool test_equ(void *data1, void *data2)
+{
+	return test_val(data1) == test_val(data2);
+}
+
+static size_t test_hash(void *data)
+{
+	return (size_t)test_val(data) * 0x9e3779b97f4a7c15ull;
+}
+
+static int test_find(void *data, void *user_data)
+{
+	return test_val(data) != *(long *)user_data;
+}
+
+static int test_long_cmp(const void *a, const void *b)
+{
+	long x = *(const long *)a, y = *(const long *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static Slist *test_create(void)
+{
+	switch (test_mode) {
+	case TEST_POOL:   return slist_create_pool(test_cmp, test_equ, NULL, NULL, test_pool);
+	case TEST_INLINE: return slist_create_inline(sizeof(long), test_cmp, test_equ, NULL);
+	default:          return slist_create_full(test_cmp, test_equ, NULL, NULL);
+	}
+}
+
+// model --- vals[0..n) is what the list must hold
+static void model_insert(TestList *t, size_t at, long v)
+{
+	memmove(t->vals + at + 1, t->vals + at, (t->n - at) * sizeof(long));
+	t->vals[at] = v;
+	t->n++;
+
+	return;
+}
+
+static void model_erase(TestList *t, size_t at)
+{
+	memmove(t->vals + at, t->vals + at + 1, (t->n - at - 1) * sizeof(long));
+	t->n--;
+
+	return;
+}
+
+static bool model_has(TestList *t, long v)
+{
+	size_t i = 0;
+
+	for (i = 0; i < t->n; i++) {
+		if (t->vals[i] == v) return true;
+	}
+
+	return false;
+}
+
+static long model_find(TestList *t, long v)
+{
+	size_t i = 0;
+
+	for (i = 0; i < t->n; i++) {
+		if (t->vals[i] == v) return (long)i;
+	}
+
+	return -1;
+}
+
+static void model_take(TestList *t, TestList *from)
+{
+	memcpy(t->vals, from->vals, from->n * sizeof(long));
+	t->n = from->n;
+	t->hash = false;
+
+	return;
+}
+
+/* merge from's values behind the equal ones of t, as slist_sort_merge does */
+static void model_merge(TestList *t, long *vals, size_t n)
+{
+	long merged[2 * TEST_CAP];
+	size_t i = 0, j = 0, k = 0;
+
+	while (i < t->n || j < n) {
+		if (j == n || (i < t->n && t->vals[i] <= vals[j])) merged[k++] = t->vals[i++];
+		else merged[k++] = vals[j++];
+	}
+	memcpy(t->vals, merged, k * sizeof(long));
+	t->n = k;
+
+	return;
+}
+
+static int test_free_slot(void)
+{
+	int j = 0;
+
+	for (j = 0; j < TEST_LISTS; j++) {
+		if (test_lists[j].list == NULL) return j;
+	}
+
+	return -1;
+}
+
+/* another live list, -1 if there is none */
+static int test_other(int i)
+{
+	int j = (int)test_rand(TEST_LISTS);
+
+	return (j != i && test_lists[j].list != NULL) ? j : -1;
+}
+
+static void test_drop(TestList *t)
+{
+	slist_clear(t->list);
+	slist_destroy(t->list);
+	t->list = NULL;
+	t->n = 0;
+	t->hash = false;
+
+	return;
+}
+
+// compare --- one walk through a cursor, which never copies a shared node
+static void test_compare(TestList *t)
+{
+	SlistCursor cursor;
+	size_t i = 0;
+
+	if (t->list == NULL) return;
+
+	CHECK(slist_count(t->list) == t->n);
+	CHECK(slist_isempty(t->list) == (t->n == 0));
+
+	slist_cursor_init(&cursor, t->list);
+	for (i = 0; i < t->n; i++) {
+		CHECK(slist_cursor_peek(&cursor) != NULL);
+		CHECK(test_val(slist_cursor_peek(&cursor)) == t->vals[i]);
+		slist_cursor_next(&cursor);
+	}
+	CHECK(slist_cursor_peek(&cursor) == NULL);
+
+	if (t->n == 0) {
+		CHECK(slist_first_data(t->list) == NULL);
+		CHECK(slist_last_data(t->list) == NULL);
+	} else {
+		CHECK(test_val(slist_first_data(t->list)) == t->vals[0]);
+		CHECK(test_val(slist_last_data(t->list)) == t->vals[t->n - 1]);
+	}
+
+	return;
+}
+
+// ops --- each keeps the model in step or checks what the list returned
+static void test_add(TestList *t, int op, long v)
+{
+	void *batch[5];
+	SlistNode *anchor = NULL;
+	size_t k = 0, i = 0;
+
+	switch (op) {
+	case 0:
+		CHECK(slist_add_data_first(t->list, test_data(v, 0)) == 0);
+		model_insert(t, 0, v);
+		break;
+	case 1:
+		CHECK(slist_add_data_last(t->list, test_data(v, 0)) == 0);
+		model_insert(t, t->n, v);
+		break;
+	case 2:
+		k = test_rand(t->n + 1);
+		CHECK(slist_add_data_index(t->list, k, test_data(v, 0)) == 0);
+		model_insert(t, k, v);
+		break;
+	case 3: /* before the first greater data, walking from the head */
+		for (k = 0; k < t->n && t->vals[k] <= v; k++);
+		CHECK(slist_add_data_sorted(t->list, test_data(v, 0)) == 0);
+		model_insert(t, k, v);
+		break;
+	case 4:
+		for (i = 0; i < 5; i++) batch[i] = test_data(v + (long)i, (int)i);
+		CHECK(slist_add_data_last_batch(t->list, batch, 5) == 0);
+		for (i = 0; i < 5; i++) model_insert(t, t->n, v + (long)i);
+		break;
+	case 5:
+		if (t->n == 0) break;
+		k = test_rand(t->n);
+		anchor = slist_get_node_by_index(t->list, k);
+		CHECK(anchor != NULL);
+		CHECK(slist_add_data_next_node_unsafe(t->list, anchor, test_data(v, 0)) == 0);
+		model_insert(t, k + 1, v);
+		break;
+	case 6:
+		if (t->n == 0) break;
+		k = test_rand(t->n);
+		anchor = slist_get_node_by_index(t->list, k);
+		CHECK(anchor != NULL);
+		CHECK(slist_add_data_prev_node(t->list, anchor, test_data(v, 0)) == 0);
+		model_insert(t, k, v);
+		break;
+	}
+
+	return;
+}
+
+static void test_remove(TestList *t, int op, long v)
+{
+	void *out[8];
+	size_t indexes[3];
+	SlistNode *node = NULL;
+	size_t k = 0, r = 0, i = 0;
+	long at = 0;
+	int ret = 0;
+
+	switch (op) {
+	case 7:
+		if (t->hash) break; /* any equal data may go */
+		at = model_find(t, v);
+		CHECK(remove_one_by_data(t->list, test_data(v, 0)) == (at >= 0 ? 0 : -1));
+		if (at >= 0) model_erase(t, (size_t)at);
+		break;
+	case 8:
+		ret = remove_all_by_data(t->list, test_data(v, 0));
+		CHECK(ret == (model_has(t, v) ? 0 : -1));
+		while ((at = model_find(t, v)) >= 0) model_erase(t, (size_t)at);
+		break;
+	case 9:
+		if (t->n == 0) break;
+		k = test_rand(t->n);
+		CHECK(test_val(remove_data_by_index(t->list, k)) == t->vals[k]);
+		model_erase(t, k);
+		break;
+	case 10:
+		if (t->n == 0) break;
+		k = test_rand(t->n);
+		node = remove_node_by_index(t->list, k);
+		CHECK(node != NULL && test_val(node->data) == t->vals[k]);
+		slist_node_release(t->list, node);
+		model_erase(t, k);
+		break;
+	case 11:
+		r = remove_data_first_batch(t->list, out, test_rand(8));
+		for (i = 0; i < r; i++) {
+			CHECK(test_val(out[i]) == t->vals[0]);
+			model_erase(t, 0);
+		}
+		break;
+	case 12:
+		if (t->n == 0) break;
+		indexes[0] = test_rand(t->n);
+		indexes[1] = indexes[0] + 1 + test_rand(3);
+		indexes[2] = indexes[1] + 1 + test_rand(3);
+		r = remove_data_by_index_batch(t->list, indexes, 3, out);
+		for (i = 0; i < r; i++) {
+			CHECK(test_val(out[i]) == t->vals[indexes[i] - i]);
+			model_erase(t, indexes[i] - i);
+		}
+		break;
+	case 13:
+		if (t->n == 0) break;
+		k = test_rand(t->n);
+		node = slist_get_node_by_index(t->list, k);
+		CHECK(node != NULL);
+		CHECK(remove_by_node(t->list, node) == 0);
+		model_erase(t, k);
+		break;
+	}
+
+	return;
+}
+
+static void test_reorder(TestList *t, int op)
+{
+	size_t k = 0;
+	long tmp = 0;
+
+	if (test_rand(4) != 0) return;
+
+	if (op == 14) {
+		CHECK(slist_reverse(t->list) == 0);
+		for (k = 0; k < t->n / 2; k++) {
+			tmp = t->vals[k];
+			t->vals[k] = t->vals[t->n - 1 - k];
+			t->vals[t->n - 1 - k] = tmp;
+		}
+	} else {
+		CHECK(slist_sort(t->list) == 0);
+		qsort(t->vals, t->n, sizeof(long), test_long_cmp);
+	}
+
+	return;
+}
+
+/* lists j comes from i: a copy, a split or what a splice leaves */
+static void test_shape(int i, int op)
+{
+	TestList *t = &test_lists[i], *u = NULL;
+	SlistNode *node = NULL;
+	size_t k = 0;
+	int j = 0;
+
+	switch (op) {
+	case 16:
+		if ((j = test_free_slot()) < 0) break;
+		u = &test_lists[j];
+		u->list = test_rand(4) ? slist_copy_lazy(t->list) : slist_copy(t->list);
+		CHECK(u->list != NULL);
+		model_take(u, t);
+		break;
+	case 17:
+	case 18:
+		if ((j = test_other(i)) < 0 || t->n + test_lists[j].n > TEST_CAP) break;
+		u = &test_lists[j];
+		if (op == 17) {
+			CHECK(slist_splice(t->list, u->list) == 0);
+		} else {
+			CHECK(slist_concat(t->list, u->list) == 0);
+			u->list = NULL;
+			u->hash = false;
+		}
+		memcpy(t->vals + t->n, u->vals, u->n * sizeof(long));
+		t->n += u->n;
+		u->n = 0;
+		break;
+	case 19:
+		if ((j = test_free_slot()) < 0) break;
+		u = &test_lists[j];
+		k = test_rand(t->n + 1);
+		u->list = slist_split_at_index(t->list, k);
+		CHECK(u->list != NULL);
+		memcpy(u->vals, t->vals + k, (t->n - k) * sizeof(long));
+		u->n = t->n - k;
+		u->hash = false;
+		t->n = k;
+		break;
+	case 20:
+		if (t->n == 0 || (j = test_free_slot()) < 0) break;
+		u = &test_lists[j];
+		k = test_rand(t->n);
+		node = slist_get_node_by_index(t->list, k);
+		CHECK(node != NULL);
+		u->list = slist_split_at_node(t->list, node);
+		CHECK(u->list != NULL);
+		memcpy(u->vals, t->vals + k + 1, (t->n - k - 1) * sizeof(long));
+		u->n = t->n - k - 1;
+		u->hash = false;
+		t->n = k + 1;
+		break;
+	case 21: /* merge of two sorted lists, the second is freed */
+		if ((j = test_other(i)) < 0 || t->n + test_lists[j].n > TEST_CAP) break;
+		u = &test_lists[j];
+		CHECK(slist_sort(t->list) == 0);
+		CHECK(slist_sort(u->list) == 0);
+		qsort(t->vals, t->n, sizeof(long), test_long_cmp);
+		qsort(u->vals, u->n, sizeof(long), test_long_cmp);
+		CHECK(slist_sort_merge(t->list, u->list) == 0);
+		model_merge(t, u->vals, u->n);
+		u->list = NULL;
+		u->n = 0;
+		u->hash = false;
+		break;
+	}
+
+	return;
+}
+
+static void test_cursor(TestList *t, long v)
+{
+	SlistCursor cursor;
+	size_t k = 0, i = 0;
+
+	slist_cursor_init(&cursor, t->list);
+	k = test_rand(t->n + 1);
+	for (i = 0; i < k; i++) slist_cursor_next(&cursor);
+
+	switch (test_rand(3)) {
+	case 0: /* the cursor stays on the node it was on */
+		CHECK(slist_cursor_insert_before(&cursor, test_data(v, 0)) == 0);
+		model_insert(t, k, v);
+		if (k + 1 < t->n) CHECK(test_val(slist_cursor_peek(&cursor)) == t->vals[k + 1]);
+		break;
+	case 1:
+		if (k == t->n) break;
+		CHECK(slist_cursor_insert_after(&cursor, test_data(v, 0)) == 0);
+		model_insert(t, k + 1, v);
+		break;
+	case 2:
+		if (k == t->n) break;
+		CHECK(test_val(slist_cursor_remove(&cursor)) == t->vals[k]);
+		model_erase(t, k);
+		if (k < t->n) CHECK(test_val(slist_cursor_peek(&cursor)) == t->vals[k]);
+		break;
+	}
+
+	return;
+}
+
+/* a handle taken from one list stays in it when the other is edited */
+static void test_handles(int i, int op, long v)
+{
+	TestList *t = &test_lists[i], *u = NULL;
+	SlistNode *node = NULL;
+	size_t k = 0, at = 0;
+	int j = 0;
+
+	if (t->n == 0 || (j = test_free_slot()) < 0) return;
+
+	u = &test_lists[j];
+	u->list = slist_copy_lazy(t->list);
+	CHECK(u->list != NULL);
+	model_take(u, t);
+	k = test_rand(t->n);
+
+	if (op == 25) { /* the source's handle, one of the two lists grows */
+		node = slist_get_node_by_index(t->list, k);
+		if (test_rand(2)) {
+			CHECK(slist_add_data_last(t->list, test_data(v, 0)) == 0);
+			model_insert(t, t->n, v);
+		} else {
+			CHECK(slist_add_data_last(u->list, test_data(v, 0)) == 0);
+			model_insert(u, u->n, v);
+		}
+		CHECK(slist_get_index_by_node(t->list, node) == (long)k);
+		CHECK(slist_get_index_by_node(u->list, node) == -1);
+		CHECK(remove_by_node(u->list, node) == -1);
+		CHECK(slist_add_data_next_node_unsafe(t->list, node, test_data(v + 1, 0)) == 0);
+		model_insert(t, k + 1, v + 1);
+	} else { /* the copy's handle, the source grows or shrinks */
+		node = slist_get_node_by_index(u->list, k);
+		if (test_rand(2)) {
+			CHECK(slist_add_data_last(t->list, test_data(v, 0)) == 0);
+			model_insert(t, t->n, v);
+		} else {
+			at = test_rand(t->n);
+			CHECK(test_val(remove_data_by_index(t->list, at)) == t->vals[at]);
+			model_erase(t, at);
+		}
+		CHECK(slist_get_index_by_node(u->list, node) == (long)k);
+		CHECK(slist_get_index_by_node(t->list, node) == -1);
+		CHECK(slist_add_data_next_node_unsafe(u->list, node, test_data(v + 1, 0)) == 0);
+		model_insert(u, k + 1, v + 1);
+	}
+
+	return;
+}
+
+/* both lists sorted first, the mode ends after the call */
+static void test_sets(int i)
+{
+	TestList *t = &test_lists[i], *u = NULL;
+	long keep[TEST_CAP], moved[TEST_CAP], ret = 0;
+	size_t k = 0, w = 0, m = 0;
+	int j = 0, kind = 0;
+
+	if ((j = test_other(i)) < 0 || t->n + test_lists[j].n > TEST_CAP) return;
+
+	u = &test_lists[j];
+	CHECK(slist_sorted_enable(t->list) == 0);
+	CHECK(slist_sorted_enable(u->list) == 0);
+	qsort(t->vals, t->n, sizeof(long), test_long_cmp);
+	qsort(u->vals, u->n, sizeof(long), test_long_cmp);
+
+	kind = (int)test_rand(3);
+	if (kind == 0) { /* u's data missing from t move over, in order */
+		for (k = 0; k < u->n; k++) {
+			if (model_has(t, u->vals[k])) keep[w++] = u->vals[k];
+			else moved[m++] = u->vals[k];
+		}
+		ret = slist_sorted_union(t->list, u->list);
+		CHECK(ret == (long)m);
+		model_merge(t, moved, m);
+		memcpy(u->vals, keep, w * sizeof(long));
+		u->n = w;
+	} else {
+		for (k = 0; k < t->n; k++) {
+			if (model_has(u, t->vals[k]) == (kind == 1)) keep[w++] = t->vals[k];
+		}
+		ret = kind == 1 ? slist_sorted_intersect(t->list, u->list) : slist_sorted_difference(t->list, u->list);
+		CHECK(ret == (long)(t->n - w));
+		memcpy(t->vals, keep, w * sizeof(long));
+		t->n = w;
+	}
+
+	slist_sorted_disable(t->list);
+	slist_sorted_disable(u->list);
+
+	return;
+}
+
+static void test_side(TestList *t)
+{
+	long left = 0;
+
+	switch (test_rand(8)) {
+	case 0: CHECK(slist_index_enable(t->list) == 0); break;
+	case 1: slist_index_disable(t->list); break;
+	case 2:
+		CHECK(slist_hash_enable(t->list, test_hash) == 0);
+		t->hash = true;
+		break;
+	case 3:
+		slist_hash_disable(t->list);
+		t->hash = false;
+		break;
+	case 4: CHECK(slist_prefetch_enable(t->list, test_rand(4) * 4) == 0); break;
+	case 5: slist_prefetch_disable(t->list); break;
+	default: /* a few nodes at a time, edits may come in between */
+		left = slist_compact(t->list, 1 + test_rand(t->n + 1));
+		if (test_mode == TEST_MALLOC) CHECK(left == -1);
+		else CHECK(left >= 0);
+		break;
+	}
+
+	return;
+}
+
+static void test_lookup(TestList *t, long v)
+{
+	SlistNode *node = NULL;
+	size_t k = 0;
+	long at = model_find(t, v);
+
+	CHECK(slist_get_index_by_data(t->list, test_data(v, 0)) == at);
+
+	node = slist_get_node_by_data(t->list, test_data(v, 0));
+	CHECK((node != NULL) == (at >= 0));
+	if (node) CHECK(test_val(node->data) == v);
+
+	node = slist_get_node_custom(t->list, test_find, &v);
+	CHECK((node != NULL) == (at >= 0));
+	if (node) CHECK(slist_get_index_by_node(t->list, node) == at);
+
+	if (t->n == 0) {
+		CHECK(slist_get_node_by_index(t->list, 0) == NULL);
+		CHECK(slist_first_node(t->list) == NULL);
+		CHECK(slist_last_node(t->list) == NULL);
+		return;
+	}
+
+	k = test_rand(t->n);
+	CHECK(test_val(slist_get_data_by_index(t->list, k)) == t->vals[k]);
+	node = slist_get_node_by_index(t->list, k);
+	CHECK(node != NULL && test_val(node->data) == t->vals[k]);
+	CHECK(slist_get_index_by_node(t->list, node) == (long)k);
+	CHECK(test_val(slist_first_node(t->list)->data) == t->vals[0]);
+	CHECK(slist_last_node(t->list)->next == NULL);
+	CHECK(test_val(slist_last_node(t->list)->data) == t->vals[t->n - 1]);
+
+	return;
+}
+
+static void test_apply(int i, int op, long v)
+{
+	TestList *t = &test_lists[i];
+
+	switch (op) {
+	case 0: case 1: case 2: case 3: case 4: case 5: case 6:
+		test_add(t, op, v);
+		break;
+	case 7: case 8: case 9: case 10: case 11: case 12: case 13:
+		test_remove(t, op, v);
+		break;
+	case 14: case 15:
+		test_reorder(t, op);
+		break;
+	case 16: case 17: case 18: case 19: case 20: case 21:
+		test_shape(i, op);
+		break;
+	case 22:
+		test_cursor(t, v);
+		break;
+	case 23:
+		if (test_rand(6) != 0) break;
+		if (test_rand(2)) slist_clear(t->list);
+		else slist_clear_deep(t->list);
+		t->n = 0;
+		break;
+	case 24:
+		if (test_rand(6) == 0) test_drop(t);
+		break;
+	case 25: case 26:
+		test_handles(i, op, v);
+		break;
+	case 27:
+		if (test_rand(4) == 0) test_sets(i);
+		break;
+	case 28:
+		if (test_rand(8) == 0) test_side(t);
+		break;
+	case 29:
+		CHECK(slist_unshare(t->list) == 0);
+		break;
+	default:
+		test_lookup(t, v);
+		break;
+	}
+
+	return;
+}
+
+static void test_run(int mode, unsigned long seed, long steps)
+{
+	TestList *t = NULL;
+	long v = 0;
+	int i = 0, j = 0;
+
+	test_mode = mode;
+	test_seed = seed;
+	test_rng = 0x2545f4914f6cdd1dull ^ (seed * 0x9e3779b97f4a7c15ull);
+	test_pool = slist_node_pool_create(64);
+	CHECK(test_pool != NULL);
+
+	for (test_step = 0; test_step < steps; test_step++) {
+		i = (int)test_rand(TEST_LISTS);
+		t = &test_lists[i];
+		test_op = -1;
+
+		if (t->list == NULL) { /* a new list or a copy of a live one */
+			j = test_other(i);
+			if (j >= 0 && test_rand(2)) {
+				t->list = test_rand(4) ? slist_copy_lazy(test_lists[j].list) : slist_copy(test_lists[j].list);
+				CHECK(t->list != NULL);
+				model_take(t, &test_lists[j]);
+			} else {
+				t->list = test_create();
+				CHECK(t->list != NULL);
+				t->n = 0;
+				t->hash = false;
+			}
+			continue;
+		}
+
+		v = 1 + (long)test_rand(TEST_VALS);
+		test_op = (int)test_rand(TEST_OPS);
+		if (t->n > TEST_CAP - 16 && (test_op <= 6 || test_op == 22 || test_op == 25 || test_op == 26))
+			test_op = 9; /* full, shrink instead */
+
+		test_apply(i, test_op, v);
+
+		for (j = 0; j < TEST_LISTS; j++) test_compare(&test_lists[j]);
+	}
+
+	for (j = 0; j < TEST_LISTS; j++) {
+		if (test_lists[j].list) test_drop(&test_lists[j]);
+	}
+	slist_node_pool_destroy(test_pool);
+	test_pool = NULL;
+
+	return;
+}
+
+static void test_usage(void)
+{
+	fprintf(stderr, "usage: slist_test [-s seeds] [-n steps]\n");
+	exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long seeds = 16, seed = 0;
+	long steps = 20000;
+	int mode = 0, opt = 0;
+
+	while ((opt = getopt(argc, argv, "s:n:")) != -1) {
+		switch (opt) {
+		case 's': seeds = strtoul(optarg, NULL, 10); break;
+		case 'n': steps = atol(optarg); break;
+		default:  test_usage();
+		}
+	}
+	if (seeds == 0 || steps <= 0) test_usage();
+
+	for (mode = 0; mode < TEST_MODES; mode++) {
+		for (seed = 1; seed <= seeds; seed++) test_run(mode, seed, steps);
+	}
+
+	printf("slist_test: %lu seeds x %ld steps in %d modes passed\n", seeds, steps, TEST_MODES);
+
+	return 0;
+}
@@ -0,0 +1,499 @@
+#ifndef __SLIST_TYPED_H__
+#define __SLIST_TYPED_H__
+
+#include <stdlib.h>
+#include <stddef.h>       /* use type size_t */
+#include <stdbool.h>      /* use type bool, true and false in C99 */
+#include <assert.h>
+
+/* typed lists: SLIST_DEFINE(name, type, cmp, equ) generates the struct
+   `name` storing type by value in its nodes and static inline name_*
+   functions mirroring the data level API of slist.h. cmp(a, b) returns
+   <0, 0, >0 and equ(a, b) true for equal data, both are expanded in place
+   so the compiler can inline them. SLIST_VALUE_CMP and SLIST_VALUE_EQU
+   work for arithmetic types and pointers.
+
+       SLIST_DEFINE(slist_i64, int64_t, SLIST_VALUE_CMP, SLIST_VALUE_EQU)
+
+       slist_i64 *list = slist_i64_create();
+       slist_i64_add_data_last(list, 42);
+*/
+
+#define SLIST_VALUE_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+#define SLIST_VALUE_EQU(a, b) ((a) == (b))
+
+#define SLIST_DEFINE(name, type, cmp, equ) \
+\
+typedef struct name##_node { \
+	struct name##_node *next; \
+	type data; \
+} name##_node; \
+\
+typedef struct name { \
+	name##_node head;          /* sentinel, head.data is unused */ \
+	name##_node *tail;         /* NULL when empty */ \
+	size_t count; \
+} name; \
+\
+/* name new */ \
+static inline name *name##_create(void) \
+{ \
+	name *list = NULL; \
+	\
+	list = (name *)malloc(sizeof(name)); \
+	if (list == NULL) return NULL; \
+	\
+	list->head.next = NULL; \
+	list->tail = NULL; \
+	list->count = 0; \
+	\
+	return list; \
+} \
+\
+/* name clear */ \
+static inline void name##_clear(name *list) \
+{ \
+	name##_node *p = NULL, *next = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	for (p = list->head.next; p; p = next) { \
+		next = p->next; \
+		free(p); \
+	} \
+	list->head.next = NULL; \
+	list->tail = NULL; \
+	list->count = 0; \
+	\
+	return; \
+} \
+\
+/* name free */ \
+static inline void name##_destroy(name *list) \
+{ \
+	assert(list != NULL); \
+	\
+	name##_clear(list); \
+	free(list); \
+	\
+	return; \
+} \
+\
+static inline size_t name##_count(name *list) \
+{ \
+	assert(list != NULL); \
+	\
+	return list->count; \
+} \
+\
+static inline bool name##_isempty(name *list) \
+{ \
+	assert(list != NULL); \
+	\
+	return list->count == 0; \
+} \
+\
+static inline name##_node *name##_node_create(type data) \
+{ \
+	name##_node *node = NULL; \
+	\
+	node = (name##_node *)malloc(sizeof(name##_node)); \
+	if (node == NULL) return NULL; \
+	\
+	node->next = NULL; \
+	node->data = data; \
+	\
+	return node; \
+} \
+\
+static inline void name##_link_after(name *list, name##_node *prev, name##_node *node) \
+{ \
+	node->next = prev->next; \
+	prev->next = node; \
+	if (node->next == NULL) list->tail = node; \
+	list->count++; \
+	\
+	return; \
+} \
+\
+static inline name##_node *name##_unlink_after(name *list, name##_node *prev) \
+{ \
+	name##_node *node = prev->next; \
+	\
+	prev->next = node->next; \
+	if (list->tail == node) list->tail = prev == &list->head ? NULL : prev; \
+	list->count--; \
+	\
+	return node; \
+} \
+\
+/* predecessor of the node at index, NULL when index > count */ \
+static inline name##_node *name##_prev_at(name *list, size_t index) \
+{ \
+	name##_node *p = NULL; \
+	\
+	if (index > list->count) return NULL; \
+	if (index == list->count && list->tail) return list->tail; \
+	\
+	for (p = &list->head; index > 0; index--) p = p->next; \
+	\
+	return p; \
+} \
+\
+/* name copy */ \
+static inline name *name##_copy(name *list) \
+{ \
+	name *new_list = NULL; \
+	name##_node *p = NULL, *node = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	new_list = name##_create(); \
+	if (new_list == NULL) return NULL; \
+	\
+	for (p = list->head.next; p; p = p->next) { \
+		node = name##_node_create(p->data); \
+		if (node == NULL) { \
+			name##_destroy(new_list); \
+			return NULL; \
+		} \
+		name##_link_after(new_list, new_list->tail ? new_list->tail : &new_list->head, node); \
+	} \
+	\
+	return new_list; \
+} \
+\
+/* add_data */ \
+static inline int name##_add_data_first(name *list, type data) \
+{ \
+	name##_node *node = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	node = name##_node_create(data); \
+	if (node == NULL) return -1; \
+	\
+	name##_link_after(list, &list->head, node); \
+	\
+	return 0; \
+} \
+\
+static inline int name##_add_data_last(name *list, type data) \
+{ \
+	name##_node *node = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	node = name##_node_create(data); \
+	if (node == NULL) return -1; \
+	\
+	name##_link_after(list, list->tail ? list->tail : &list->head, node); \
+	\
+	return 0; \
+} \
+\
+static inline int name##_add_data_index(name *list, size_t index, type data) \
+{ \
+	name##_node *prev = NULL, *node = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	prev = name##_prev_at(list, index); \
+	if (prev == NULL) return -1; \
+	\
+	node = name##_node_create(data); \
+	if (node == NULL) return -2; \
+	\
+	name##_link_after(list, prev, node); \
+	\
+	return 0; \
+} \
+\
+/* after the last data that is not greater, equal data keep insertion order */ \
+static inline int name##_add_data_sorted(name *list, type data) \
+{ \
+	name##_node *prev = NULL, *node = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	node = name##_node_create(data); \
+	if (node == NULL) return -1; \
+	\
+	prev = &list->head; \
+	if (list->tail && cmp(list->tail->data, data) <= 0) { \
+		prev = list->tail; \
+	} else { \
+		while (prev->next && cmp(prev->next->data, data) <= 0) prev = prev->next; \
+	} \
+	name##_link_after(list, prev, node); \
+	\
+	return 0; \
+} \
+\
+/* remove */ \
+static inline int name##_remove_one_by_data(name *list, type data) \
+{ \
+	name##_node *prev = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	for (prev = &list->head; prev->next; prev = prev->next) { \
+		if (equ(prev->next->data, data)) { \
+			free(name##_unlink_after(list, prev)); \
+			return 0; \
+		} \
+	} \
+	\
+	return -1; \
+} \
+\
+static inline int name##_remove_all_by_data(name *list, type data) \
+{ \
+	name##_node *prev = NULL; \
+	int ret = -1; \
+	\
+	assert(list != NULL); \
+	\
+	prev = &list->head; \
+	while (prev->next) { \
+		if (equ(prev->next->data, data)) { \
+			free(name##_unlink_after(list, prev)); \
+			ret = 0; \
+		} else { \
+			prev = prev->next; \
+		} \
+	} \
+	\
+	return ret; \
+} \
+\
+/* the removed data goes to *data when data is not NULL */ \
+static inline int name##_remove_data_by_index(name *list, size_t index, type *data) \
+{ \
+	name##_node *prev = NULL, *node = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	if (index >= list->count) return -1; \
+	\
+	prev = name##_prev_at(list, index); \
+	node = name##_unlink_after(list, prev); \
+	if (data) *data = node->data; \
+	free(node); \
+	\
+	return 0; \
+} \
+\
+static inline int name##_remove_data_first(name *list, type *data) \
+{ \
+	return name##_remove_data_by_index(list, 0, data); \
+} \
+\
+/* get --- pointers into the node, valid until the node is removed */ \
+static inline name##_node *name##_get_node_by_index(name *list, size_t index) \
+{ \
+	assert(list != NULL); \
+	\
+	if (index >= list->count) return NULL; \
+	\
+	return name##_prev_at(list, index)->next; \
+} \
+\
+static inline name##_node *name##_get_node_by_data(name *list, type data) \
+{ \
+	name##_node *p = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	for (p = list->head.next; p; p = p->next) { \
+		if (equ(p->data, data)) return p; \
+	} \
+	\
+	return NULL; \
+} \
+\
+static inline type *name##_get_data_by_index(name *list, size_t index) \
+{ \
+	name##_node *node = NULL; \
+	\
+	node = name##_get_node_by_index(list, index); \
+	\
+	return node ? &node->data : NULL; \
+} \
+\
+static inline long name##_get_index_by_data(name *list, type data) \
+{ \
+	name##_node *p = NULL; \
+	long index = 0; \
+	\
+	assert(list != NULL); \
+	\
+	for (p = list->head.next; p; p = p->next, index++) { \
+		if (equ(p->data, data)) return index; \
+	} \
+	\
+	return -1; \
+} \
+\
+/* first and last --- O(1), NULL when empty */ \
+static inline type *name##_first_data(name *list) \
+{ \
+	assert(list != NULL); \
+	\
+	return list->head.next ? &list->head.next->data : NULL; \
+} \
+\
+static inline type *name##_last_data(name *list) \
+{ \
+	assert(list != NULL); \
+	\
+	return list->tail ? &list->tail->data : NULL; \
+} \
+\
+/* reverse --- O(n) */ \
+static inline void name##_reverse(name *list) \
+{ \
+	name##_node *p = NULL, *next = NULL, *reversed = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	list->tail = list->head.next; \
+	for (p = list->head.next; p; p = next) { \
+		next = p->next; \
+		p->next = reversed; \
+		reversed = p; \
+	} \
+	list->head.next = reversed; \
+	\
+	return; \
+} \
+\
+static inline name##_node *name##_merge_nodes(name##_node *a, name##_node *b) \
+{ \
+	name##_node merged, *p = &merged; \
+	\
+	while (a && b) { \
+		if (cmp(a->data, b->data) <= 0) { \
+			p->next = a; \
+			a = a->next; \
+		} else { \
+			p->next = b; \
+			b = b->next; \
+		} \
+		p = p->next; \
+	} \
+	p->next = a ? a : b; \
+	\
+	return merged.next; \
+} \
+\
+/* sort --- O(nlogn), stable, the same bottom-up merge as slist_sort */ \
+static inline void name##_sort(name *list) \
+{ \
+	name##_node *runs[sizeof(size_t) * 8 + 1] = {NULL}; \
+	name##_node *p = NULL, *next = NULL, *carry = NULL; \
+	size_t i = 0, max_run = 0; \
+	\
+	assert(list != NULL); \
+	\
+	if (list->count < 2) return; \
+	\
+	for (p = list->head.next; p; p = next) { \
+		next = p->next; \
+		p->next = NULL; \
+		\
+		carry = p; \
+		for (i = 0; runs[i] != NULL; i++) { \
+			carry = name##_merge_nodes(runs[i], carry); \
+			runs[i] = NULL; \
+		} \
+		runs[i] = carry; \
+		if (i > max_run) max_run = i; \
+	} \
+	\
+	carry = NULL; \
+	for (i = 0; i <= max_run; i++) { \
+		if (runs[i] != NULL) carry = name##_merge_nodes(runs[i], carry); \
+	} \
+	list->head.next = carry; \
+	\
+	for (p = carry; p->next; p = p->next); \
+	list->tail = p; \
+	\
+	return; \
+} \
+\
+/* both sorted, list2 is merged into list1 and freed. O(n+m) */ \
+static inline void name##_sort_merge(name *list1, name *list2) \
+{ \
+	assert(list1 != NULL); \
+	assert(list2 != NULL); \
+	\
+	if (list2->count > 0) { \
+		if (list1->tail == NULL || cmp(list1->tail->data, list2->tail->data) <= 0) \
+			list1->tail = list2->tail; \
+		list1->head.next = name##_merge_nodes(list1->head.next, list2->head.next); \
+		list1->count += list2->count; \
+	} \
+	free(list2); \
+	\
+	return; \
+} \
+\
+/* move all nodes of list to the end of target, list stays empty. O(1) */ \
+static inline void name##_splice(name *target, name *list) \
+{ \
+	assert(target != NULL); \
+	assert(list != NULL); \
+	assert(target != list); \
+	\
+	if (list->count == 0) return; \
+	\
+	(target->tail ? target->tail : &target->head)->next = list->head.next; \
+	target->tail = list->tail; \
+	target->count += list->count; \
+	\
+	list->head.next = NULL; \
+	list->tail = NULL; \
+	list->count = 0; \
+	\
+	return; \
+} \
+\
+/* free list, append list to target. O(1) */ \
+static inline void name##_concat(name *target, name *list) \
+{ \
+	name##_splice(target, list); \
+	free(list); \
+	\
+	return; \
+} \
+\
+/* the nodes from index on move to the returned list */ \
+static inline name *name##_split_at_index(name *list, size_t index) \
+{ \
+	name *new_list = NULL; \
+	name##_node *prev = NULL; \
+	\
+	assert(list != NULL); \
+	\
+	prev = name##_prev_at(list, index); \
+	if (prev == NULL) return NULL; \
+	\
+	new_list = name##_create(); \
+	if (new_list == NULL) return NULL; \
+	\
+	if (prev->next) { \
+		new_list->head.next = prev->next; \
+		new_list->tail = list->tail; \
+		new_list->count = list->count - index; \
+		\
+		prev->next = NULL; \
+		list->tail = prev == &list->head ? NULL : prev; \
+		list->count = index; \
+	} \
+	\
+	return new_list; \
+}
+
+#endif //__SLIST_TYPED_H__
@@ -0,0 +1,994 @@
+#include "slist_unrolled.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SLIST_UNROLLED_SIMD    /* slots are 8 bytes, SSE2 is always there */
+#include <immintrin.h>
+#endif
+
+struct SlistUnrolledBlock {
+	struct SlistUnrolledBlock *next;
+	size_t used;
+	void *data[SLIST_UNROLLED_SLOTS];
+};
+
+struct SlistUnrolled {
+	struct SlistUnrolledBlock *head;  /* no sentinel, NULL when empty */
+	struct SlistUnrolledBlock *tail;
+	size_t count;
+
+	SlistDataCmp  *data_cmp;
+	SlistDataEqu  *data_equ;
+	SlistDataCopy *data_copy;
+	SlistDataFree *data_free;
+};
+
+typedef struct SlistUnrolledBlock SlistUnrolledBlock;
+
+/* bit i set when slot i of a block, i < used, holds key */
+typedef unsigned SlistUnrolledMatch(void *const *slots, size_t used, int64_t key);
+
+static SlistUnrolledBlock *slist_unrolled_block_create(void);
+static SlistUnrolledBlock *slist_unrolled_block_at(SlistUnrolled *list, size_t *index, SlistUnrolledBlock **prev);
+static SlistUnrolled *slist_unrolled_copy_with(SlistUnrolled *list, bool deep);
+static int slist_unrolled_insert_slot(SlistUnrolled *list, SlistUnrolledBlock *block, size_t slot, void *data);
+static void slist_unrolled_merge(SlistDataCmp *data_cmp, void **a, size_t na, void **b, size_t nb, void **out);
+static void slist_unrolled_gather(SlistUnrolled *list, void **data);
+static void slist_unrolled_scatter(SlistUnrolled *list, void **data);
+static void slist_unrolled_remove_slot(SlistUnrolled *list, SlistUnrolledBlock *prev, SlistUnrolledBlock *block, size_t slot);
+static bool slist_unrolled_block_merge_next(SlistUnrolled *list, SlistUnrolledBlock *block);
+static SlistUnrolledMatch *slist_unrolled_match_select(void);
+static int slist_unrolled_mask_first(unsigned mask);
+static int slist_unrolled_mask_count(unsigned mask);
+
+// SlistUnrolled new
+SlistUnrolled *slist_unrolled_create(void)
+{
+	return slist_unrolled_create_full(NULL, NULL, NULL, NULL);
+}
+
+SlistUnrolled *slist_unrolled_create_full(SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistDataCopy *data_copy, SlistDataFree *data_free)
+{
+	SlistUnrolled *list = NULL;
+
+	list = (SlistUnrolled *)malloc(sizeof(SlistUnrolled));
+	if (list == NULL) return NULL;
+
+	assert(list != NULL);
+
+	list->head = NULL;
+	list->tail = NULL;
+	list->count = 0;
+
+	list->data_cmp  = data_cmp;
+	list->data_equ  = data_equ;
+	list->data_copy = data_copy;
+	list->data_free = data_free;
+
+	return list;
+}
+
+// SlistUnrolled free
+void slist_unrolled_destroy(SlistUnrolled *list)
+{
+	assert(list != NULL);
+	assert(list->count == 0);
+
+	slist_unrolled_clear(list);
+	free(list);
+
+	return;
+}
+
+void slist_unrolled_destroy_deep(SlistUnrolled *list)
+{
+	assert(list != NULL);
+
+	slist_unrolled_clear_deep(list);
+
+	slist_unrolled_destroy(list);
+
+	return;
+}
+
+// SlistUnrolled clear
+void slist_unrolled_clear(SlistUnrolled *list)
+{
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+
+	while (list->head) {
+		block = list->head;
+		list->head = block->next;
+		free(block);
+	}
+
+	list->tail = NULL;
+	list->count = 0;
+
+	return;
+}
+
+void slist_unrolled_clear_deep(SlistUnrolled *list)
+{
+	size_t i = 0;
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+
+	if (list->data_free) {
+		for (block = list->head; block; block = block->next) {
+			for (i = 0; i < block->used; i++)
+				list->data_free(block->data[i]);
+		}
+	}
+
+	slist_unrolled_clear(list);
+
+	return;
+}
+
+size_t slist_unrolled_count(SlistUnrolled *list)
+{
+	assert(list != NULL);
+
+	return list->count;
+}
+
+bool slist_unrolled_isempty(SlistUnrolled *list)
+{
+	assert(list != NULL);
+
+	return list->count == 0;
+}
+
+// SlistUnrolled copy --- block by block, the copy keeps the fill of every block
+SlistUnrolled *slist_unrolled_copy(SlistUnrolled *list)
+{
+	return slist_unrolled_copy_with(list, false);
+}
+
+SlistUnrolled *slist_unrolled_copy_deep(SlistUnrolled *list)
+{
+	return slist_unrolled_copy_with(list, true);
+}
+
+static SlistUnrolled *slist_unrolled_copy_with(SlistUnrolled *list, bool deep)
+{
+	size_t i = 0;
+	SlistUnrolled *new_list = NULL;
+	SlistUnrolledBlock *block = NULL, *copy = NULL;
+
+	assert(list != NULL);
+	assert(!deep || list->data_copy != NULL);
+
+	new_list = slist_unrolled_create_full(list->data_cmp, list->data_equ, list->data_copy, list->data_free);
+	if (new_list == NULL) return NULL;
+
+	for (block = list->head; block; block = block->next) {
+		copy = slist_unrolled_block_create();
+		if (copy == NULL) {
+			if (deep) {
+				slist_unrolled_destroy_deep(new_list);
+			} else {
+				slist_unrolled_clear(new_list);
+				slist_unrolled_destroy(new_list);
+			}
+			return NULL;
+		}
+
+		if (deep) {
+			for (i = 0; i < block->used; i++)
+				copy->data[i] = list->data_copy(block->data[i]);
+		} else {
+			memcpy(copy->data, block->data, block->used * sizeof(void *));
+		}
+		copy->used = block->used;
+
+		if (new_list->tail)
+			new_list->tail->next = copy;
+		else
+			new_list->head = copy;
+		new_list->tail = copy; /* maintain tail pointer */
+		new_list->count += copy->used;
+	}
+
+	assert(new_list->count == list->count);
+
+	return new_list;
+}
+
+static SlistUnrolledBlock *slist_unrolled_block_create(void)
+{
+	SlistUnrolledBlock *block = NULL;
+
+	/* 2 whole cache lines, a multiple of the alignment as aligned_alloc wants */
+	block = (SlistUnrolledBlock *)aligned_alloc(64, sizeof(SlistUnrolledBlock));
+	if (block == NULL) return NULL;
+
+	assert(block != NULL);
+
+	block->next = NULL;
+	block->used = 0;
+
+	return block;
+}
+
+/* find the block holding position *index, *index becomes the slot in it */
+static SlistUnrolledBlock *slist_unrolled_block_at(SlistUnrolled *list, size_t *index, SlistUnrolledBlock **prev)
+{
+	SlistUnrolledBlock *block = NULL, *before = NULL;
+
+	assert(list != NULL);
+	assert(*index < list->count);
+
+	block = list->head;
+	while (*index >= block->used) {
+		*index -= block->used;
+		before = block;
+		block = block->next;
+	}
+
+	if (prev) *prev = before;
+
+	return block;
+}
+
+// add_data
+int slist_unrolled_add_data_first(SlistUnrolled *list, void *data)  // O(SLOTS)
+{
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+
+	block = list->head;
+	if (block == NULL || block->used == SLIST_UNROLLED_SLOTS) {
+		block = slist_unrolled_block_create();
+		if (block == NULL) return -1;
+
+		block->next = list->head;
+		list->head = block;
+		if (list->tail == NULL) /* maintain tail pointer */
+			list->tail = block;
+	}
+
+	memmove(&block->data[1], &block->data[0], block->used * sizeof(void *));
+	block->data[0] = data;
+	block->used++;
+	list->count++;
+
+	return 0;
+}
+
+int slist_unrolled_add_data_last(SlistUnrolled *list, void *data)   // O(1)
+{
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+
+	block = list->tail;
+	if (block == NULL || block->used == SLIST_UNROLLED_SLOTS) {
+		block = slist_unrolled_block_create();
+		if (block == NULL) return -1;
+
+		if (list->tail)
+			list->tail->next = block;
+		else
+			list->head = block;
+		list->tail = block; /* maintain tail pointer */
+	}
+
+	block->data[block->used++] = data;
+	list->count++;
+
+	return 0;
+}
+
+int slist_unrolled_add_data_index(SlistUnrolled *list, size_t index, void *data) // O(n/SLOTS)
+{
+	size_t slot = index;
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+
+	if (index > list->count) return -1;
+	if (index == list->count) {
+		if (slist_unrolled_add_data_last(list, data) != 0) return -2;
+		return 0;
+	}
+
+	assert(index < list->count);
+
+	block = slist_unrolled_block_at(list, &slot, NULL);
+	if (slist_unrolled_insert_slot(list, block, slot, data) != 0) return -2;
+
+	return 0;
+}
+
+//after the last data not greater than data, one compare skips a whole block
+int slist_unrolled_add_data_sorted(SlistUnrolled *list, void *data) // O(n/SLOTS + SLOTS)
+{
+	size_t slot = 0;
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+	assert(list->data_cmp != NULL);
+
+	for (block = list->head; block; block = block->next) {
+		if (list->data_cmp(block->data[block->used - 1], data) > 0) break;
+	}
+	if (block == NULL) return slist_unrolled_add_data_last(list, data);
+
+	while (list->data_cmp(block->data[slot], data) <= 0) slot++;
+
+	return slist_unrolled_insert_slot(list, block, slot, data);
+}
+
+/* data goes in before slot of block, slot < used */
+static int slist_unrolled_insert_slot(SlistUnrolled *list, SlistUnrolledBlock *block, size_t slot, void *data)
+{
+	SlistUnrolledBlock *split = NULL;
+
+	assert(list != NULL);
+	assert(block != NULL);
+	assert(slot < block->used);
+
+	if (block->used == SLIST_UNROLLED_SLOTS) { /* split the full block in half */
+		split = slist_unrolled_block_create();
+		if (split == NULL) return -1;
+
+		split->used = SLIST_UNROLLED_SLOTS / 2;
+		block->used = SLIST_UNROLLED_SLOTS - split->used;
+		memcpy(split->data, &block->data[block->used], split->used * sizeof(void *));
+
+		split->next = block->next;
+		block->next = split;
+		if (list->tail == block) /* maintain tail pointer */
+			list->tail = split;
+
+		if (slot > block->used) {
+			slot -= block->used;
+			block = split;
+		}
+	}
+
+	memmove(&block->data[slot + 1], &block->data[slot], (block->used - slot) * sizeof(void *));
+	block->data[slot] = data;
+	block->used++;
+	list->count++;
+
+	return 0;
+}
+
+// remove
+/* fold the next block into a less than half full one so scans stay dense */
+static bool slist_unrolled_block_merge_next(SlistUnrolled *list, SlistUnrolledBlock *block)
+{
+	SlistUnrolledBlock *next = NULL;
+
+	assert(list != NULL);
+	assert(block != NULL);
+
+	next = block->next;
+	if (next == NULL) return false;
+	if (block->used >= SLIST_UNROLLED_SLOTS / 2) return false;
+	if (block->used + next->used > SLIST_UNROLLED_SLOTS) return false;
+
+	memcpy(&block->data[block->used], next->data, next->used * sizeof(void *));
+	block->used += next->used;
+
+	block->next = next->next;
+	if (list->tail == next) /* maintain tail pointer */
+		list->tail = block;
+	free(next);
+
+	return true;
+}
+
+static void slist_unrolled_remove_slot(SlistUnrolled *list, SlistUnrolledBlock *prev, SlistUnrolledBlock *block, size_t slot)
+{
+	assert(list != NULL);
+	assert(block != NULL);
+	assert(slot < block->used);
+
+	block->used--;
+	memmove(&block->data[slot], &block->data[slot + 1], (block->used - slot) * sizeof(void *));
+	list->count--;
+
+	if (block->used == 0) {
+		if (prev)
+			prev->next = block->next;
+		else
+			list->head = block->next;
+
+		if (list->tail == block) /* maintain tail pointer */
+			list->tail = prev;
+
+		free(block);
+		return;
+	}
+
+	slist_unrolled_block_merge_next(list, block);
+
+	return;
+}
+
+int slist_unrolled_remove_one_by_data(SlistUnrolled *list, void *data)
+{
+	size_t i = 0;
+	SlistUnrolledBlock *block = NULL, *prev = NULL;
+
+	assert(list != NULL);
+	assert(list->data_equ != NULL);
+
+	for (block = list->head; block; prev = block, block = block->next) {
+		for (i = 0; i < block->used; i++) {
+			if (list->data_equ(block->data[i], data)) {
+				if (list->data_free) list->data_free(block->data[i]);
+				slist_unrolled_remove_slot(list, prev, block, i);
+				return 0;
+			}
+		}
+	}
+
+	return -1;
+}
+
+int slist_unrolled_remove_all_by_data(SlistUnrolled *list, void *data)
+{
+	int ret = -1;
+	size_t i = 0, kept = 0;
+	void *copy_data = data;
+	SlistUnrolledBlock *block = NULL, *prev = NULL, *next = NULL;
+
+	assert(list != NULL);
+	assert(list->data_equ != NULL);
+
+	if (list->data_copy && list->data_free) /* data may be one of the elements freed below */
+		copy_data = list->data_copy(data);
+
+	/* compact every block in place, one pass */
+	for (block = list->head; block; block = next) {
+		next = block->next;
+
+		for (i = 0, kept = 0; i < block->used; i++) {
+			if (list->data_equ(block->data[i], copy_data)) {
+				if (list->data_free) list->data_free(block->data[i]);
+				list->count--;
+				ret = 0;
+				continue;
+			}
+			block->data[kept++] = block->data[i];
+		}
+		block->used = kept;
+
+		if (kept == 0) {
+			if (prev)
+				prev->next = next;
+			else
+				list->head = next;
+			free(block);
+			continue;
+		}
+
+		if (prev && slist_unrolled_block_merge_next(list, prev)) continue;
+		prev = block;
+	}
+	list->tail = prev; /* maintain tail pointer */
+
+	if (copy_data != data)
+		list->data_free(copy_data);
+
+	return ret;
+}
+
+void *slist_unrolled_remove_data_by_index(SlistUnrolled *list, size_t index)
+{
+	void *ret_data = NULL;
+	SlistUnrolledBlock *block = NULL, *prev = NULL;
+
+	assert(list != NULL);
+
+	if (index >= list->count) return NULL;
+
+	block = slist_unrolled_block_at(list, &index, &prev);
+
+	ret_data = block->data[index];
+	slist_unrolled_remove_slot(list, prev, block, index);
+
+	return ret_data;
+}
+
+// get
+void *slist_unrolled_get_data_by_index(SlistUnrolled *list, size_t index)
+{
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+
+	if (index >= list->count) return NULL;
+
+	block = slist_unrolled_block_at(list, &index, NULL);
+
+	return block->data[index];
+}
+
+long slist_unrolled_get_index_by_data(SlistUnrolled *list, void *data)
+{
+	long index = 0;
+	size_t i = 0;
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+	assert(list->data_equ != NULL);
+
+	for (block = list->head; block; block = block->next) {
+		for (i = 0; i < block->used; i++) {
+			if (list->data_equ(block->data[i], data)) return index + (long)i;
+		}
+		index += (long)block->used;
+	}
+
+	return -1;
+}
+
+void *slist_unrolled_get_data_custom(SlistUnrolled *list, SlistDataFind *data_find, void *user_data)
+{
+	size_t i = 0;
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+	assert(data_find != NULL);
+
+	for (block = list->head; block; block = block->next) {
+		for (i = 0; i < block->used; i++) {
+			if (data_find(block->data[i], user_data) == 0) return block->data[i];
+		}
+	}
+
+	return NULL;
+}
+
+// search by key --- a mask of matching slots per block
+#ifdef SLIST_UNROLLED_SIMD
+__attribute__((target("avx2")))
+static unsigned slist_unrolled_match_avx2(void *const *slots, size_t used, int64_t key)
+{
+	const __m256i k4 = _mm256_set1_epi64x(key);
+	const __m128i k2 = _mm_set1_epi64x(key);
+	__m256i v4;
+	__m128i v2;
+	unsigned mask = 0;
+	size_t i = 0;
+
+	/* slots past used are still inside the block, their bits are dropped */
+	for (i = 0; i + 4 <= SLIST_UNROLLED_SLOTS; i += 4) {
+		v4 = _mm256_loadu_si256((const __m256i *)&slots[i]);
+		mask |= (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v4, k4))) << i;
+	}
+	for (; i + 2 <= SLIST_UNROLLED_SLOTS; i += 2) {
+		v2 = _mm_loadu_si128((const __m128i *)&slots[i]);
+		mask |= (unsigned)_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(v2, k2))) << i;
+	}
+	for (; i < SLIST_UNROLLED_SLOTS; i++) {
+		if ((int64_t)(intptr_t)slots[i] == key) mask |= 1u << i;
+	}
+
+	return mask & ((1u << used) - 1);
+}
+
+static unsigned slist_unrolled_match_sse2(void *const *slots, size_t used, int64_t key)
+{
+	const __m128i k2 = _mm_set1_epi64x(key);
+	__m128i v2, eq;
+	unsigned mask = 0;
+	size_t i = 0;
+
+	/* no 64 bit compare in SSE2: both 32 bit halves have to be equal */
+	for (i = 0; i + 2 <= SLIST_UNROLLED_SLOTS; i += 2) {
+		v2 = _mm_loadu_si128((const __m128i *)&slots[i]);
+		eq = _mm_cmpeq_epi32(v2, k2);
+		eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+		mask |= (unsigned)_mm_movemask_pd(_mm_castsi128_pd(eq)) << i;
+	}
+	for (; i < SLIST_UNROLLED_SLOTS; i++) {
+		if ((int64_t)(intptr_t)slots[i] == key) mask |= 1u << i;
+	}
+
+	return mask & ((1u << used) - 1);
+}
+#else
+static unsigned slist_unrolled_match_scalar(void *const *slots, size_t used, int64_t key)
+{
+	unsigned mask = 0;
+	size_t i = 0;
+
+	for (i = 0; i < used; i++) {
+		if ((int64_t)(intptr_t)slots[i] == key) mask |= 1u << i;
+	}
+
+	return mask;
+}
+#endif
+
+/* once per search, the cpu features are read at startup by the runtime */
+static SlistUnrolledMatch *slist_unrolled_match_select(void)
+{
+#ifdef SLIST_UNROLLED_SIMD
+	if (__builtin_cpu_supports("avx2")) return slist_unrolled_match_avx2;
+	return slist_unrolled_match_sse2;
+#else
+	return slist_unrolled_match_scalar;
+#endif
+}
+
+static int slist_unrolled_mask_first(unsigned mask)
+{
+	int i = 0;
+
+	assert(mask != 0);
+
+#if defined(__GNUC__)
+	i = __builtin_ctz(mask);
+#else
+	while ((mask & 1u) == 0) {
+		mask >>= 1;
+		i++;
+	}
+#endif
+
+	return i;
+}
+
+static int slist_unrolled_mask_count(unsigned mask)
+{
+	int n = 0;
+
+#if defined(__GNUC__)
+	n = __builtin_popcount(mask);
+#else
+	for (; mask; mask &= mask - 1) n++;
+#endif
+
+	return n;
+}
+
+long slist_unrolled_get_index_by_int(SlistUnrolled *list, int64_t key)
+{
+	long index = 0;
+	unsigned mask = 0;
+	SlistUnrolledMatch *match = NULL;
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+
+	match = slist_unrolled_match_select();
+	for (block = list->head; block; block = block->next) {
+		mask = match(block->data, block->used, key);
+		if (mask) return index + slist_unrolled_mask_first(mask);
+		index += (long)block->used;
+	}
+
+	return -1;
+}
+
+size_t slist_unrolled_count_int(SlistUnrolled *list, int64_t key)
+{
+	size_t matched = 0;
+	SlistUnrolledMatch *match = NULL;
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+
+	match = slist_unrolled_match_select();
+	for (block = list->head; block; block = block->next)
+		matched += (size_t)slist_unrolled_mask_count(match(block->data, block->used, key));
+
+	return matched;
+}
+
+size_t slist_unrolled_get_indexes_by_int(SlistUnrolled *list, int64_t key, size_t *indexes, size_t n)
+{
+	size_t matched = 0, index = 0;
+	unsigned mask = 0;
+	SlistUnrolledMatch *match = NULL;
+	SlistUnrolledBlock *block = NULL;
+
+	assert(list != NULL);
+	assert(indexes != NULL || n == 0);
+
+	match = slist_unrolled_match_select();
+	for (block = list->head; block; block = block->next) {
+		for (mask = match(block->data, block->used, key); mask; mask &= mask - 1) {
+			if (matched < n) indexes[matched] = index + (size_t)slist_unrolled_mask_first(mask);
+			matched++;
+		}
+		index += block->used;
+	}
+
+	return matched;
+}
+
+int slist_unrolled_remove_all_by_int(SlistUnrolled *list, int64_t key)
+{
+	int ret = -1;
+	size_t i = 0, kept = 0;
+	unsigned mask = 0;
+	SlistUnrolledMatch *match = NULL;
+	SlistUnrolledBlock *block = NULL, *prev = NULL, *next = NULL;
+
+	assert(list != NULL);
+
+	/* blocks without a match are only looked at, not rewritten */
+	match = slist_unrolled_match_select();
+	for (block = list->head; block; block = next) {
+		next = block->next;
+
+		mask = match(block->data, block->used, key);
+		if (mask) {
+			for (i = 0, kept = 0; i < block->used; i++) {
+				if ((mask & (1u << i)) == 0) block->data[kept++] = block->data[i];
+			}
+			list->count -= block->used - kept;
+			block->used = kept;
+			ret = 0;
+		}
+
+		if (block->used == 0) {
+			if (prev)
+				prev->next = next;
+			else
+				list->head = next;
+			free(block);
+			continue;
+		}
+
+		if (prev && slist_unrolled_block_merge_next(list, prev)) continue;
+		prev = block;
+	}
+	list->tail = prev; /* maintain tail pointer */
+
+	return ret;
+}
+
+// first and last --- O(1)
+void *slist_unrolled_first_data(SlistUnrolled *list)
+{
+	assert(list != NULL);
+
+	if (list->head == NULL) return NULL;
+
+	return list->head->data[0];
+}
+
+void *slist_unrolled_last_data(SlistUnrolled *list)
+{
+	assert(list != NULL);
+
+	if (list->tail == NULL) return NULL;
+
+	return list->tail->data[list->tail->used - 1];
+}
+
+// reverse --- O(n)
+void slist_unrolled_reverse(SlistUnrolled *list)
+{
+	size_t i = 0;
+	void *tmp = NULL;
+	SlistUnrolledBlock *block = NULL, *prev = NULL, *next = NULL;
+
+	assert(list != NULL);
+
+	list->tail = list->head;
+	for (block = list->head; block; block = next) {
+		next = block->next;
+		block->next = prev;
+		prev = block;
+
+		for (i = 0; i < block->used / 2; i++) {
+			tmp = block->data[i];
+			block->data[i] = block->data[block->used - 1 - i];
+			block->data[block->used - 1 - i] = tmp;
+		}
+	}
+	list->head = prev;
+
+	return;
+}
+
+// sort --- O(nlogn), stable. the data are sorted in one buffer and written
+// back, every block keeps its fill. -1 when the buffer cannot be had.
+int slist_unrolled_sort(SlistUnrolled *list)
+{
+	size_t width = 0, lo = 0, mid = 0, hi = 0;
+	void **buffer = NULL, **data = NULL, **out = NULL, **tmp = NULL;
+
+	assert(list != NULL);
+	assert(list->data_cmp != NULL);
+
+	if (list->count < 2) return 0;
+
+	buffer = (void **)malloc(2 * list->count * sizeof(void *));
+	if (buffer == NULL) return -1;
+
+	data = buffer;
+	out = buffer + list->count;
+	slist_unrolled_gather(list, data);
+
+	for (width = 1; width < list->count; width *= 2) { /* bottom-up, runs of width */
+		for (lo = 0; lo < list->count; lo += 2 * width) {
+			mid = lo + width < list->count ? lo + width : list->count;
+			hi = mid + width < list->count ? mid + width : list->count;
+			slist_unrolled_merge(list->data_cmp, &data[lo], mid - lo, &data[mid], hi - mid, &out[lo]);
+		}
+		tmp = data;
+		data = out;
+		out = tmp;
+	}
+
+	slist_unrolled_scatter(list, data);
+	free(buffer);
+
+	return 0;
+}
+
+//sort merge --- O(n+m), both lists sorted, list2 is merged into list1 and freed.
+//-1 when the buffer cannot be had, list2 is kept.
+int slist_unrolled_sort_merge(SlistUnrolled *list1, SlistUnrolled *list2)
+{
+	size_t n1 = 0, n2 = 0;
+	void **buffer = NULL;
+
+	assert(list1 != NULL);
+	assert(list2 != NULL);
+	assert(list1 != list2);
+	assert(list1->data_cmp != NULL);
+
+	n1 = list1->count;
+	n2 = list2->count;
+	if (n1 > 0 && n2 > 0) {
+		buffer = (void **)malloc(2 * (n1 + n2) * sizeof(void *));
+		if (buffer == NULL) return -1;
+
+		slist_unrolled_gather(list1, buffer);
+		slist_unrolled_gather(list2, buffer + n1);
+		slist_unrolled_merge(list1->data_cmp, buffer, n1, buffer + n1, n2, buffer + n1 + n2);
+	}
+
+	slist_unrolled_concat(list1, list2); /* the blocks are reused as they are */
+
+	if (buffer) {
+		slist_unrolled_scatter(list1, buffer + n1 + n2);
+		free(buffer);
+	}
+
+	return 0;
+}
+
+//free list, append its blocks to target. O(1)
+void slist_unrolled_concat(SlistUnrolled *target, SlistUnrolled *list)
+{
+	SlistUnrolledBlock *seam = NULL;
+
+	assert(target != NULL);
+	assert(list != NULL);
+	assert(target != list);
+
+	if (list->head) {
+		seam = target->tail;
+		if (seam)
+			seam->next = list->head;
+		else
+			target->head = list->head;
+		target->tail = list->tail; /* maintain tail pointer */
+		target->count += list->count;
+
+		if (seam) slist_unrolled_block_merge_next(target, seam);
+
+		list->head = NULL;
+		list->tail = NULL;
+		list->count = 0;
+	}
+
+	slist_unrolled_destroy(list);
+
+	return;
+}
+
+//split --- data from index on move to the returned list, NULL when index is
+//past the end or out of memory. O(n/SLOTS)
+SlistUnrolled *slist_unrolled_split_at_index(SlistUnrolled *list, size_t index)
+{
+	size_t slot = index;
+	SlistUnrolled *new_list = NULL;
+	SlistUnrolledBlock *block = NULL, *prev = NULL, *rest = NULL;
+
+	assert(list != NULL);
+
+	if (index > list->count) return NULL;
+
+	new_list = slist_unrolled_create_full(list->data_cmp, list->data_equ, list->data_copy, list->data_free);
+	if (new_list == NULL) return NULL;
+
+	if (index == list->count) return new_list;
+
+	block = slist_unrolled_block_at(list, &slot, &prev);
+
+	if (slot > 0) { /* the block is cut, its last slots get a block of their own */
+		rest = slist_unrolled_block_create();
+		if (rest == NULL) {
+			slist_unrolled_destroy(new_list);
+			return NULL;
+		}
+
+		rest->used = block->used - slot;
+		memcpy(rest->data, &block->data[slot], rest->used * sizeof(void *));
+		block->used = slot;
+
+		rest->next = block->next;
+		block->next = NULL;
+		new_list->head = rest;
+		new_list->tail = (list->tail == block) ? rest : list->tail;
+		list->tail = block;
+	} else {
+		if (prev)
+			prev->next = NULL;
+		else
+			list->head = NULL;
+		new_list->head = block;
+		new_list->tail = list->tail;
+		list->tail = prev;
+	}
+
+	new_list->count = list->count - index;
+	list->count = index;
+
+	return new_list;
+}
+
+/* stable: on equal data a goes first */
+static void slist_unrolled_merge(SlistDataCmp *data_cmp, void **a, size_t na, void **b, size_t nb, void **out)
+{
+	size_t i = 0, j = 0, k = 0;
+
+	while (i < na && j < nb) {
+		if (data_cmp(a[i], b[j]) <= 0)
+			out[k++] = a[i++];
+		else
+			out[k++] = b[j++];
+	}
+	while (i < na) out[k++] = a[i++];
+	while (j < nb) out[k++] = b[j++];
+
+	return;
+}
+
+/* every data of the list in order into data[] */
+static void slist_unrolled_gather(SlistUnrolled *list, void **data)
+{
+	SlistUnrolledBlock *block = NULL;
+
+	for (block = list->head; block; block = block->next) {
+		memcpy(data, block->data, block->used * sizeof(void *));
+		data += block->used;
+	}
+
+	return;
+}
+
+/* data[] back into the slots in order, the fill of every block is kept */
+static void slist_unrolled_scatter(SlistUnrolled *list, void **data)
+{
+	SlistUnrolledBlock *block = NULL;
+
+	for (block = list->head; block; block = block->next) {
+		memcpy(block->data, data, block->used * sizeof(void *));
+		data += block->used;
+	}
+
+	return;
+}
@@ -0,0 +1,82 @@
+#ifndef __SLIST_UNROLLED_H__
+#define __SLIST_UNROLLED_H__
+
+#include "slist.h"        /* share the data callback types */
+#include <stdint.h>       /* int64_t keys */
+
+/* unrolled storage: every block holds up to SLIST_UNROLLED_SLOTS data
+   pointers, a block is 128 bytes on a cache line boundary so a scan touches
+   2 cache lines per 14 elements instead of one line per element. */
+#define SLIST_UNROLLED_SLOTS 14
+
+typedef struct SlistUnrolled SlistUnrolled;
+
+// SlistUnrolled new
+SlistUnrolled *slist_unrolled_create(void);
+SlistUnrolled *slist_unrolled_create_full(SlistDataCmp *data_cmp, SlistDataEqu *data_equ, SlistDataCopy *data_copy, SlistDataFree *data_free);
+
+// SlistUnrolled copy --- O(n/SLOTS) blocks, copy_deep needs data_copy
+SlistUnrolled *slist_unrolled_copy(SlistUnrolled *list);
+SlistUnrolled *slist_unrolled_copy_deep(SlistUnrolled *list);
+
+// SlistUnrolled free
+void slist_unrolled_destroy(SlistUnrolled *list);
+void slist_unrolled_destroy_deep(SlistUnrolled *list);
+
+// SlistUnrolled clear
+void slist_unrolled_clear(SlistUnrolled *list);
+void slist_unrolled_clear_deep(SlistUnrolled *list);
+
+size_t slist_unrolled_count(SlistUnrolled *list);
+
+bool slist_unrolled_isempty(SlistUnrolled *list);
+
+// add_data
+int slist_unrolled_add_data_first(SlistUnrolled *list, void *data);  // O(SLOTS)
+int slist_unrolled_add_data_last(SlistUnrolled *list, void *data);   // O(1)
+int slist_unrolled_add_data_index(SlistUnrolled *list, size_t index, void *data); // O(n/SLOTS)
+int slist_unrolled_add_data_sorted(SlistUnrolled *list, void *data); // O(n/SLOTS + SLOTS), after equal data
+
+// remove
+int slist_unrolled_remove_one_by_data(SlistUnrolled *list, void *data);
+int slist_unrolled_remove_all_by_data(SlistUnrolled *list, void *data);
+void *slist_unrolled_remove_data_by_index(SlistUnrolled *list, size_t index);
+
+// get
+void *slist_unrolled_get_data_by_index(SlistUnrolled *list, size_t index);
+long slist_unrolled_get_index_by_data(SlistUnrolled *list, void *data);
+void *slist_unrolled_get_data_custom(SlistUnrolled *list, SlistDataFind *data_find, void *user_data);
+
+// search by key --- for lists whose slots hold integers instead of pointers,
+// added as (void *)(intptr_t)key; int32 keys compare the same way. A block's
+// slots are compared 4 (AVX2) or 2 (SSE2) at a time, picked at run time by
+// cpuid, one at a time elsewhere. No callback is involved.
+long slist_unrolled_get_index_by_int(SlistUnrolled *list, int64_t key);
+size_t slist_unrolled_count_int(SlistUnrolled *list, int64_t key);
+//the first n matching indexes go to indexes[], returns the number of matches
+size_t slist_unrolled_get_indexes_by_int(SlistUnrolled *list, int64_t key, size_t *indexes, size_t n);
+//nothing is freed, the slots are values
+int slist_unrolled_remove_all_by_int(SlistUnrolled *list, int64_t key);
+
+// first and last --- O(1)
+void *slist_unrolled_first_data(SlistUnrolled *list);
+void *slist_unrolled_last_data(SlistUnrolled *list);
+
+// reverse --- O(n)
+void slist_unrolled_reverse(SlistUnrolled *list);
+
+// sort --- O(nlogn), stable, sorts the data in one buffer of n pointers and
+// writes them back. -1 when the buffer cannot be had, the list is unchanged.
+int slist_unrolled_sort(SlistUnrolled *list);
+
+//sort merge --- O(n+m), both lists sorted, list2 is merged into list1 and
+//freed. -1 out of memory as for sort, list2 is kept.
+int slist_unrolled_sort_merge(SlistUnrolled *list1, SlistUnrolled *list2);
+
+//free list, append its blocks to target. O(1)
+void slist_unrolled_concat(SlistUnrolled *target, SlistUnrolled *list);
+
+//split --- data from index on move to the returned list. O(n/SLOTS)
+SlistUnrolled *slist_unrolled_split_at_index(SlistUnrolled *list, size_t index);
+
+#endif //__SLIST_UNROLLED_H__